@@ -0,0 +1,53 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#define RF_BENCH_NAME_LEN 24
+
+/**
+* @brief Result of a benchmark case
+*/
+typedef struct {
+    char name[RF_BENCH_NAME_LEN];      // "<parser>/<stream>" or name of the function
+    uint32_t pulses;                   // number of processed pulses (calls for functions)
+    uint32_t ns_per_pulse;             // mean time per pulse
+    uint32_t pulses_per_sec;
+    uint32_t events;                   // number of events emitted by one pass over the stream
+} rf_bench_result_t;
+
+/**
+* @brief Run benchmark of protocol parsers
+*
+* Every parser and the parsers task loop with 1, 4 and 11 protocols are fed with synthesized streams
+* of clean frames, pure noise and mixed traffic, every case with new parsers. Pulses come from memory, so the driver
+* doesn't need to be installed and the benchmark doesn't need a radio or GPIO, it can run on the host (linux target) too.
+*
+* Results are logged one per line in CSV format with the baseline values and the status:
+*
+*     rf_bench,<name>,<pulses>,<ns_per_pulse>,<pulses_per_sec>,<events>,<baseline_ns>,<baseline_events>,<status>
+*
+* Status is "ok", "new" if the case is not in the baseline, "changed" if the number of events differs
+* from the baseline or "slower" if the time exceeds the baseline by more than CONFIG_RF_MODULE_BENCHMARK_TOLERANCE
+* percent. Streams are generated with fixed seeds, so the events don't depend on the platform. On the linux target
+* the timings are logged for information only and never "slower".
+*
+* @param results Array of results to fill, can be NULL
+* @param results_num Capacity of the array, filled with number of results
+*
+* @return
+*     - ESP_ERR_INVALID_ARG Parameter error
+*     - ESP_ERR_NO_MEM Out of memory
+*     - ESP_FAIL Some results are slower or changed
+*     - ESP_OK Success
+*/
+esp_err_t rf_bench_run(rf_bench_result_t *results, size_t *results_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,10 +22,65 @@ extern "C" {
 typedef struct {
     uint8_t action;
     uint8_t bits;
+    uint8_t confidence;                // 100 if the code is decoded from a single frame, less if reconstructed
+                                       // from several damaged frames by majority vote, percent
     uint64_t raw_code;
     uint16_t protocol;
+    uint32_t tag;                      // user tag of the code if it is in known codes table, 0 otherwise
 } rf_event_t;
 
+/**
+* @brief Data struct for known code
+*/
+typedef struct {
+    uint16_t protocol;
+    uint8_t bits;
+    uint64_t raw_code;
+    uint32_t tag;                      // user defined value passed back in rf_event_t, can't be 0
+} rf_code_t;
+
+#define RF_ENCODING_PULSE_WIDTH    0  // bits differ in ratio of HIGH and LOW pulses, bit width is fixed
+#define RF_ENCODING_PULSE_DISTANCE 1  // bits differ in width of LOW pulse, HIGH pulse is fixed
+
+/**
+* @brief Range of widths in microseconds
+*/
+typedef struct {
+    int min;
+    int max;
+} rf_range_t;
+
+/**
+* @brief Data struct for protocol parameters found in learning mode
+*/
+typedef struct {
+    uint8_t encoding;                  // RF_ENCODING_PULSE_WIDTH or RF_ENCODING_PULSE_DISTANCE
+    int code_bits_len;                 // length of the code in bits
+    uint64_t raw_code;                 // the most frequent code captured
+    int frames;                        // number of captured frames with the code length
+
+    // pulse width encoding, parameters of pulse parser
+    int clock_us;                      // clock tick width
+    int sync_clk;                      // sync pulse width in clock ticks
+    int bit_clk;                       // bit pulse width in clock ticks
+    bool inverted;                     // first pulse is LOW
+    int sync_tolerance;                // max deviation of captured SYNC widths from the mean, percent
+    int bit_tolerance;                 // max deviation of captured bit widths from the mean, percent
+
+    // pulse distance encoding, windows of pulse distance protocol descriptor (like King-Serry)
+    rf_range_t sync_start_us;          // HIGH pulse of SYNC
+    rf_range_t sync_width_us;          // HIGH + LOW pulses of SYNC
+    rf_range_t bit_start_0_us;         // HIGH pulse of '0'
+    rf_range_t bit_start_1_us;         // HIGH pulse of '1'
+    rf_range_t bit_width_0_us;         // HIGH + LOW pulses of '0'
+    rf_range_t bit_width_1_us;         // HIGH + LOW pulses of '1'
+} rf_learned_protocol_t;
+
+/**
+* @brief Handle of events reader, see rf_events_reader_new()
+*/
+typedef struct rf_events_reader_s *rf_events_reader_handle_t;
+
 /**
 * @brief Data struct for configuration parameters
 */
@@ -35,6 +90,13 @@ typedef struct {
     size_t pulses_queue_size;          // Size of pulses queue
     UBaseType_t parser_task_priority;  // Priority of the task that parses RF data
     uint8_t events;                    // Events to send from the driver
+    size_t codes_table_size;           // Max number of known codes, 0 disables filtering by known codes
+    size_t unknown_codes_sample;       // Send every N-th sequence of unknown codes, 0 drops them all
+    size_t events_ring_size;           // Size of broadcast events ring, rounded up to a power of 2,
+                                       // 0 disables the ring, otherwise the events queue is not used
+    bool diversity_enabled;            // Combine events of the second RF receiver with the first one
+    gpio_num_t diversity_gpio_num;     // Second RF receiver's GPIO number, used if diversity_enabled
+    uint32_t diversity_window_ms;      // Max time between the same code from both receivers to merge them, 0 for default (200)
 } rf_config_t;
 
 /**
@@ -47,6 +109,11 @@ typedef struct {
         .pulses_queue_size = 120,   \
         .parser_task_priority = 10, \
         .events = RF_EVENT_START | RF_EVENT_CONTINUE | RF_EVENT_STOP, \
+        .codes_table_size = 0,      \
+        .unknown_codes_sample = 0,  \
+        .events_ring_size = 0,      \
+        .diversity_enabled = false, \
+        .diversity_window_ms = 0,   \
     }
 
 /**
@@ -75,14 +142,141 @@ esp_err_t rf_driver_install(int intr_alloc_flags);
 /**
 * @brief Get events queue
 *
+* The queue is not used when the broadcast events ring is enabled, see rf_events_reader_new().
+*
 * @param events Pointer to events handle
 *
 * @return
 *     - ESP_ERR_INVALID_ARG Parameter error
+*     - ESP_ERR_INVALID_STATE Events ring is enabled
 *     - ESP_OK Success
 */
 esp_err_t rf_get_events_handle(QueueHandle_t *events);
 
+/**
+* @brief Create a reader of broadcast events ring
+*
+* Unlike the events queue, every reader gets all events. The driver never waits for readers:
+* a reader that lags more than rf_config_t::events_ring_size events loses the oldest ones.
+* When the ring is enabled events are not sent to the events queue.
+*
+* @param reader Pointer to reader handle, the reader gets events sent after this call
+*
+* @return
+*     - ESP_ERR_INVALID_ARG Parameter error
+*     - ESP_ERR_INVALID_STATE Events ring is not enabled
+*     - ESP_ERR_NO_MEM Out of memory
+*     - ESP_OK Success
+*/
+esp_err_t rf_events_reader_new(rf_events_reader_handle_t *reader);
+
+/**
+* @brief Delete the reader of broadcast events ring
+*
+* @param reader Reader handle, nobody must wait in rf_events_read() with it
+*
+* @return
+*     - ESP_ERR_INVALID_ARG Parameter error
+*     - ESP_OK Success
+*/
+esp_err_t rf_events_reader_delete(rf_events_reader_handle_t reader);
+
+/**
+* @brief Read the next event from broadcast events ring
+*
+* @param reader Reader handle
+* @param event Pointer to event
+* @param missed Filled with number of events lost by the reader before this one, can be NULL
+* @param ticks_to_wait Max time to wait for an event
+*
+* @return
+*     - ESP_ERR_INVALID_ARG Parameter error
+*     - ESP_ERR_TIMEOUT No events
+*     - ESP_OK Success
+*/
+esp_err_t rf_events_read(rf_events_reader_handle_t reader, rf_event_t *event, uint32_t *missed,
+                         TickType_t ticks_to_wait);
+
+/**
+* @brief Get number of events the reader has not read yet
+*
+* @param reader Reader handle
+* @param lag Pointer to number of events, more than the ring size means some events are lost
+*
+* @return
+*     - ESP_ERR_INVALID_ARG Parameter error
+*     - ESP_OK Success
+*/
+esp_err_t rf_events_reader_lag(rf_events_reader_handle_t reader, uint32_t *lag);
+
+/**
+* @brief Add codes to known codes table or update their tags
+*
+* Only events with known codes are sent when the table is enabled (see rf_config_t::codes_table_size).
+* Can be called at any time after the driver is installed.
+*
+* @param codes Array of codes, tag 0 is reserved for unknown codes
+* @param codes_num Number of codes in the array
+*
+* @return
+*     - ESP_ERR_INVALID_ARG Parameter error or a code with tag 0, no codes are added
+*     - ESP_ERR_INVALID_STATE Known codes table is not enabled
+*     - ESP_ERR_NO_MEM The table is full, codes before the failed one are added
+*     - ESP_OK Success
+*/
+esp_err_t rf_codes_add(const rf_code_t *codes, size_t codes_num);
+
+/**
+* @brief Remove code from known codes table
+*
+* @return
+*     - ESP_ERR_INVALID_STATE Known codes table is not enabled
+*     - ESP_ERR_NOT_FOUND The code is not in the table
+*     - ESP_OK Success
+*/
+esp_err_t rf_codes_remove(uint16_t protocol, uint8_t bits, uint64_t raw_code);
+
+/**
+* @brief Remove all codes from known codes table
+*
+* @return
+*     - ESP_ERR_INVALID_STATE Known codes table is not enabled
+*     - ESP_OK Success
+*/
+esp_err_t rf_codes_clear(void);
+
+/**
+* @brief Start capturing pulses to learn a new protocol
+*
+* Start it and hold the remote's button, then call rf_learn_stop().
+* Protocol parsers keep working while pulses are captured.
+*
+* @param pulses_num Number of pulses to capture, 0 for default (1024)
+*
+* @return
+*     - ESP_ERR_INVALID_STATE Driver is not installed or learning is already started
+*     - ESP_ERR_NO_MEM Out of memory
+*     - ESP_OK Success
+*/
+esp_err_t rf_learn_start(size_t pulses_num);
+
+/**
+* @brief Stop capturing pulses and find protocol parameters
+*
+* Widths of captured pulses are clustered, the longest frequent pulse is taken as frame separator
+* and the frames of the most common length are analysed to find the encoding and timings.
+*
+* @param protocol Pointer to protocol parameters
+*
+* @return
+*     - ESP_ERR_INVALID_ARG Parameter error
+*     - ESP_ERR_INVALID_STATE Learning is not started
+*     - ESP_ERR_NOT_FOUND No repeating frames found in captured pulses
+*     - ESP_ERR_NO_MEM Out of memory
+*     - ESP_OK Success
+*/
+esp_err_t rf_learn_stop(rf_learned_protocol_t *protocol);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "driver/rf_bench.h"
+#include "sdkconfig.h"
+
+/*
+ Baseline of the parsers benchmark, see rf_bench_run().
+
+ Streams are generated with fixed seeds, so the numbers of events are the same on every platform.
+ The time depends on the chip and clock, it is compared only when ns_per_pulse is not 0: paste the values
+ from the benchmark log of the reference machine (name, pulses, ns_per_pulse, pulses_per_sec, events).
+
+ The timings are of the host tests (linux target, x86-64, Release build), they are logged next to the results
+ for information and never compared: the host is shared with other jobs. No reference board is measured yet,
+ so on the chips only the events are compared too.
+*/
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+#define BASELINE(name, pulses, ns_per_pulse, pulses_per_sec, events) \
+    {name, pulses, ns_per_pulse, pulses_per_sec, events}
+#else
+#define BASELINE(name, pulses, ns_per_pulse, pulses_per_sec, events) \
+    {name, 0, 0, 0, events}
+#endif
+
+static const rf_bench_result_t s_baseline[] = {
+        BASELINE("next_pulse", 100000, 3, 259740259, 0),
+        BASELINE("reset", 100000, 2, 396825396, 50000),
+        BASELINE("register_code", 100000, 3, 280898876, 100000),
+        BASELINE("ev1527/clean", 15957760, 6, 159555262, 4),
+        BASELINE("p2/clean", 15733536, 6, 157329066, 4),
+        BASELINE("p3/clean", 15634528, 6, 156332773, 4),
+        BASELINE("p4/clean", 16385824, 6, 163838579, 4),
+        BASELINE("p5/clean", 16021824, 6, 160210229, 4),
+        BASELINE("ht6p20b/clean", 15765568, 6, 157646221, 5),
+        BASELINE("hs2303/clean", 16184896, 6, 161837631, 4),
+        BASELINE("1byone/clean", 16327584, 6, 163257881, 10),
+        BASELINE("ht12e/clean", 16269344, 6, 162682052, 10),
+        BASELINE("sm5212/clean", 18878496, 5, 188779296, 5),
+        BASELINE("kingserry/clean", 14956032, 6, 149549851, 5),
+        BASELINE("task1/clean", 10060960, 9, 100595516, 4),
+        BASELINE("task4/clean", 8194368, 12, 81919104, 16),
+        BASELINE("task11/clean", 3517696, 28, 35168519, 59),
+        BASELINE("ev1527/noise", 15951872, 6, 159501174, 0),
+        BASELINE("p2/noise", 13541376, 7, 135398866, 0),
+        BASELINE("p3/noise", 15179776, 6, 151794724, 0),
+        BASELINE("p4/noise", 12294144, 8, 122938981, 0),
+        BASELINE("p5/noise", 15116288, 6, 151158345, 0),
+        BASELINE("ht6p20b/noise", 15478784, 6, 154783196, 0),
+        BASELINE("hs2303/noise", 14469120, 6, 144686859, 0),
+        BASELINE("1byone/noise", 15712256, 6, 157103707, 0),
+        BASELINE("ht12e/noise", 14856192, 6, 148545579, 0),
+        BASELINE("sm5212/noise", 18087936, 5, 180873933, 0),
+        BASELINE("kingserry/noise", 14610432, 6, 146098476, 0),
+        BASELINE("task1/noise", 11806720, 8, 118062477, 0),
+        BASELINE("task4/noise", 8982528, 11, 89825280, 0),
+        BASELINE("task11/noise", 5681152, 17, 56802431, 0),
+        BASELINE("ev1527/mixed", 9340445, 10, 93352172, 4),
+        BASELINE("p2/mixed", 9219694, 10, 92169289, 2),
+        BASELINE("p3/mixed", 11009650, 9, 110094298, 0),
+        BASELINE("p4/mixed", 13829541, 7, 138276051, 2),
+        BASELINE("p5/mixed", 14397781, 6, 143915926, 3),
+        BASELINE("ht6p20b/mixed", 17345526, 5, 173434447, 5),
+        BASELINE("hs2303/mixed", 15022845, 6, 150180392, 0),
+        BASELINE("1byone/mixed", 13928983, 7, 139261977, 5),
+        BASELINE("ht12e/mixed", 15235935, 6, 152347162, 5),
+        BASELINE("sm5212/mixed", 16116707, 6, 161149343, 4),
+        BASELINE("kingserry/mixed", 14802652, 6, 148025039, 0),
+        BASELINE("task1/mixed", 13914777, 7, 139121336, 4),
+        BASELINE("task4/mixed", 9120252, 10, 91135990, 8),
+        BASELINE("task11/mixed", 4070019, 24, 40698155, 30),
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "driver/rf_receiver.h"
+
+#include <stdint.h>
+#include <esp_err.h>
+
+/*
+ Table of known codes.
+
+ Open addressing hash table with linear probing keyed by (protocol, bits, raw_code).
+ The table is not thread safe, the caller must serialize access.
+*/
+
+typedef struct {
+    uint64_t raw_code;
+    uint32_t tag;
+    uint16_t protocol;
+    uint8_t bits;
+    uint8_t used;
+} code_entry_t;
+
+typedef struct {
+    code_entry_t *entries;
+    uint32_t mask;         // number of slots - 1, number of slots is power of 2
+    size_t count;          // number of codes in the table
+    size_t max_count;      // max number of codes, keeps load factor below 3/4
+} code_table_t;
+
+/**
+ * @brief Create a new table
+ *
+ * @param max_count: max number of codes to keep
+ * @return
+ *      Handle of the table or NULL
+ */
+code_table_t *code_table_new(size_t max_count);
+
+/**
+ * @brief Free the table
+ */
+void code_table_free(code_table_t *table);
+
+/**
+ * @brief Add the code or update tag of already known code
+ *
+ * @return
+ *     - ESP_ERR_NO_MEM The table is full
+ *     - ESP_OK Success
+ */
+esp_err_t code_table_put(code_table_t *table, const rf_code_t *code);
+
+/**
+ * @brief Look the code up
+ *
+ * @param tag: filled with user tag of the code if found, can be NULL
+ * @return
+ *      true if the code is known
+ */
+bool code_table_get(const code_table_t *table, uint16_t protocol, uint8_t bits, uint64_t raw_code, uint32_t *tag);
+
+/**
+ * @brief Remove the code
+ *
+ * @return
+ *      true if the code was in the table
+ */
+bool code_table_remove(code_table_t *table, uint16_t protocol, uint8_t bits, uint64_t raw_code);
+
+/**
+ * @brief Remove all codes
+ */
+void code_table_clear(code_table_t *table);
+
+/*
+ Filter of events by the table.
+
+ Events of known codes pass with the tag of the code. Sequences of unknown codes are sampled:
+ every sample-th sequence passes whole (START, CONTINUE and STOP), the others are dropped.
+ The filter is not thread safe, the caller must serialize access together with the table.
+*/
+
+#define CODE_FILTER_PROTOCOLS_MAX 32  // pulse protocols and descriptors of pulse distance parser
+
+typedef struct {
+    uint16_t protocol;
+    bool sampled;          // the current sequence of unknown code of the protocol passes
+} code_filter_protocol_t;
+
+typedef struct {
+    size_t sample;         // 0 if unknown codes never pass
+    size_t unknown_num;    // number of sequences of unknown codes
+    size_t protocols_num;
+    code_filter_protocol_t protocols[CODE_FILTER_PROTOCOLS_MAX];  // protocols with sequences of unknown codes
+} code_filter_t;
+
+/**
+ * @brief Initialize the filter
+ *
+ * @param sample: every sample-th sequence of unknown codes passes, 0 to drop them all
+ */
+void code_filter_init(code_filter_t *filter, size_t sample);
+
+/**
+ * @brief Check the event's code against the table and set the event's tag
+ *
+ * Sequences of different protocols are sampled separately, also the ones of one parser with several
+ * descriptors. Unknown codes of protocols beyond CODE_FILTER_PROTOCOLS_MAX are dropped.
+ *
+ * @return
+ *      true if the event must be sent
+ */
+bool code_filter_pass(code_filter_t *filter, const code_table_t *table, rf_event_t *event);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "rf433_types.h"
+
+#include <stdint.h>
+#include <esp_err.h>
+
+/*
+ Pulse dispatcher.
+
+ Parsers in the middle of a code get every pulse. Idle parsers get only pulse pairs that may be their SYNC.
+ The candidates are looked up in a table indexed by quantized widths of the pair, so in idle noise
+ the work per pulse does not depend on number of parsers.
+*/
+
+#define DISPATCH_PARSERS_MAX     16
+#define DISPATCH_OCTAVE_MIN      6   // widths below 64us go to the first bin
+#define DISPATCH_OCTAVES         9   // widths above 32ms go to the last bin
+#define DISPATCH_BINS_PER_OCTAVE 4
+#define DISPATCH_BINS            (DISPATCH_OCTAVES * DISPATCH_BINS_PER_OCTAVE)
+
+typedef uint16_t parsers_mask_t;
+
+/**
+ * @brief Handler of the event emitted by the parser n
+ */
+typedef void (*dispatch_handler_t)(int n, rf_event_t *event, void *arg);
+
+typedef struct {
+    parser_t **parsers;
+    int parsers_num;
+
+    parsers_mask_t active;           // parsers which are not idle
+    parsers_mask_t first_level[2];   // parsers which SYNC starts with LOW / HIGH pulse
+    parsers_mask_t *candidates;      // DISPATCH_BINS x DISPATCH_BINS table: first width bin, second width bin
+    pulse_t last_pulse;
+} dispatch_t;
+
+/**
+ * @brief Build the candidates table for the parsers
+ *
+ * @param parsers:     array of parsers, must outlive the dispatcher
+ * @param parsers_num: number of parsers
+ * @return
+ *     - ESP_ERR_INVALID_ARG Too many parsers
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t dispatch_init(dispatch_t *d, parser_t **parsers, int parsers_num);
+
+/**
+ * @brief Free the candidates table, the parsers are not deleted
+ */
+void dispatch_deinit(dispatch_t *d);
+
+/**
+ * @brief Select parsers to feed the pulse to
+ *
+ * Idle candidates are primed with the previous pulse.
+ * Call dispatch_update() for every selected parser after it consumed the pulse.
+ *
+ * @return
+ *      mask of the parsers
+ */
+parsers_mask_t dispatch_select(dispatch_t *d, const pulse_t *pulse);
+
+/**
+ * @brief Update state of the parser after it consumed the pulse
+ */
+static inline void dispatch_update(dispatch_t *d, int n) {
+    if (d->parsers[n]->is_idle(d->parsers[n])) {
+        d->active &= ~(1U << n);
+    } else {
+        d->active |= 1U << n;
+    }
+}
+
+/**
+ * @brief Feed the pulse to the selected parsers and pass all their events to the handler
+ *
+ * This is the loop of the parsers task, the benchmark and the tests run the same one.
+ *
+ * @param handler: called for every event, in order of the parsers
+ * @param arg:     passed to the handler
+ */
+void dispatch_pulse(dispatch_t *d, const pulse_t *pulse, dispatch_handler_t handler, void *arg);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "driver/rf_receiver.h"
+
+#include <stdint.h>
+
+/*
+ Diversity combining of events from several receivers.
+
+ Receivers decoding the same (protocol, code) produce a single START/CONTINUE/STOP sequence. START comes
+ from the receiver that decoded the code first. Every frame is passed once: the shortest time between
+ events of one receiver is the frame period, and an event comes through if no other one did within half
+ of it, so a frame missed by one receiver comes from the other. Until the period is known, CONTINUE
+ events come from one receiver (the leader) and the other one takes over if the leader is silent for
+ longer than the window. STOP is sent when all receivers stopped and none of them resumed within the window.
+*/
+
+#define DIVERSITY_SLOTS     8
+#define DIVERSITY_RECEIVERS 2
+
+typedef struct {
+    uint64_t raw_code;
+    int64_t last_us;       // time of the latest passed event or of the latest STOP
+    int64_t heard_us[DIVERSITY_RECEIVERS];  // time of the latest event of every receiver
+    int64_t period_us;     // frame period, 0 if not known yet
+    uint16_t protocol;
+    uint8_t bits;
+    uint8_t parser;        // index of the parser that decoded the code
+    uint8_t receivers;     // mask of receivers in the middle of the sequence, 0 means STOP is pending
+    uint8_t heard;         // mask of receivers with the time in heard_us
+    uint8_t leader;        // receiver of the latest passed event
+    bool used;
+} diversity_slot_t;
+
+typedef struct {
+    diversity_slot_t slots[DIVERSITY_SLOTS];
+    int64_t window_us;
+} diversity_t;
+
+/**
+ * @brief Initialize the combiner
+ *
+ * @param window_us: max time between the same events from different receivers to merge them
+ */
+void diversity_init(diversity_t *d, int64_t window_us);
+
+/**
+ * @brief Process the event from the receiver
+ *
+ * @param receiver: index of the receiver, less than DIVERSITY_RECEIVERS
+ * @param parser:   index of the parser that emitted the event
+ * @param event:    event, action can be changed (e.g. START of a resumed sequence becomes CONTINUE)
+ * @param now_us:   current time
+ * @return
+ *      true if the event must be sent
+ */
+bool diversity_input(diversity_t *d, int receiver, int parser, rf_event_t *event, int64_t now_us);
+
+/**
+ * @brief Get pending STOP event which window is over
+ *
+ * @param parser: filled with index of the parser that emitted the event
+ * @return
+ *      true if the event is filled and must be sent
+ */
+bool diversity_flush(diversity_t *d, int64_t now_us, rf_event_t *event, int *parser);
+
+/**
+ * @brief Check there are STOP events waiting for the window to end
+ */
+bool diversity_pending(const diversity_t *d);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "driver/rf_receiver.h"
+
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_err.h>
+
+/*
+ Broadcast ring of events.
+
+ One writer, any number of readers. Every reader has its own cursor, so all readers see all events.
+ The writer never waits for readers: a reader that lags more than the ring size loses the oldest events
+ and gets the number of lost events with the next one.
+*/
+
+typedef struct events_ring_s events_ring_t;
+
+struct rf_events_reader_s {
+    events_ring_t *ring;
+    uint32_t cursor;                   // sequence number of the next event to read
+    SemaphoreHandle_t ready;           // given by the writer on every new event
+    struct rf_events_reader_s *next;
+};
+
+struct events_ring_s {
+    rf_event_t *events;
+    uint32_t size;                     // power of 2
+    uint32_t head;                     // sequence number of the next event to write
+    SemaphoreHandle_t lock;
+    struct rf_events_reader_s *readers;
+};
+
+/**
+ * @brief Create a new ring
+ *
+ * @param size: number of events to keep, rounded up to a power of 2
+ * @return
+ *      Handle of the ring or NULL
+ */
+events_ring_t *events_ring_new(size_t size);
+
+/**
+ * @brief Put the event to the ring and wake up readers
+ */
+void events_ring_write(events_ring_t *ring, const rf_event_t *event);
+
+/**
+ * @brief Create a reader, it gets events written after this call
+ *
+ * @return
+ *      Handle of the reader or NULL
+ */
+rf_events_reader_handle_t events_ring_reader_new(events_ring_t *ring);
+
+/**
+ * @brief Delete the reader
+ */
+void events_ring_reader_delete(rf_events_reader_handle_t reader);
+
+/**
+ * @brief Read the next event
+ *
+ * @param missed: filled with number of events lost before this one, can be NULL
+ * @return
+ *     - ESP_ERR_TIMEOUT No events within ticks_to_wait
+ *     - ESP_OK Success
+ */
+esp_err_t events_ring_read(rf_events_reader_handle_t reader, rf_event_t *event, uint32_t *missed,
+                           TickType_t ticks_to_wait);
+
+/**
+ * @brief Get number of events written but not read yet, may exceed the ring size
+ */
+uint32_t events_ring_lag(rf_events_reader_handle_t reader);
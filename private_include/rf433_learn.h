@@ -0,0 +1,32 @@
+#pragma once
+
+#include "driver/rf_receiver.h"
+#include "rf433_types.h"
+#include "rf433_pulse_parser.h"
+#include "rf433_pd_parser.h"
+
+#include <stddef.h>
+#include <esp_err.h>
+
+/**
+ * @brief Find protocol parameters in captured pulses
+ *
+ * @param pulses:   captured pulses, time_us == 0 is a gap in capture
+ * @param len:      number of pulses
+ * @param protocol: filled with found parameters
+ * @return
+ *     - ESP_ERR_NOT_FOUND No repeating frames found
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t learn_analyze(const pulse_t *pulses, size_t len, rf_learned_protocol_t *protocol);
+
+/**
+ * @brief Configuration of pulse parser for the protocol learned with pulse width encoding
+ */
+void learn_pulse_config(const rf_learned_protocol_t *learned, pulse_parser_config_t *config);
+
+/**
+ * @brief Descriptor of pulse distance parser for the protocol learned with pulse distance encoding
+ */
+void learn_pd_protocol(const rf_learned_protocol_t *learned, pd_protocol_t *protocol);
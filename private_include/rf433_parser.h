@@ -41,3 +41,7 @@ void start_new_code(parser_runtime_t *p);
 bool register_code(parser_runtime_t *p, rf_event_t *event);
 
 bool reset(parser_runtime_t *p, rf_event_t *event);
+
+bool is_idle(const parser_runtime_t *p);
+
+void set_first_pulse(parser_runtime_t *p, const pulse_t *pulse);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "driver/rf_receiver.h"
+#include "rf433_types.h"
+
+#include <stdint.h>
+#include <esp_err.h>
+
+/*
+ Table driven parser of pulse distance and pulse width protocols.
+
+ A frame is SYNC {HIGH, LOW} followed by bits {HIGH, LOW}. Bits differ in the width of the pair
+ (pulse distance, e.g. King-Serry or NEC) or in the width of HIGH pulse (pulse width), so both are
+ described by the same windows and a new protocol of the family is a descriptor, not a parser.
+
+ One parser evaluates several descriptors: every pulse pair is classified once for all of them
+ by looking up both widths in tables of window edges merged over the descriptors.
+*/
+
+#define PD_PROTOCOLS_MAX 16
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+} pd_range_t;
+
+typedef struct {
+    uint16_t id;                // protocol ID
+    uint8_t code_bits_len;      // length of the code in bits, up to 64
+    pd_range_t sync_start_us;   // HIGH pulse of SYNC
+    pd_range_t sync_width_us;   // HIGH + LOW pulses of SYNC
+    pd_range_t bit_start_0_us;  // HIGH pulse of '0'
+    pd_range_t bit_start_1_us;  // HIGH pulse of '1'
+    pd_range_t bit_width_0_us;  // HIGH + LOW pulses of '0'
+    pd_range_t bit_width_1_us;  // HIGH + LOW pulses of '1'
+} pd_protocol_t;
+
+#define PD_ANY_US {.min = 0, .max = UINT16_MAX}
+
+/**
+ * @brief Creat a new parser
+ *
+ * The code of a protocol is registered on SYNC of the next frame, so the last frame of a transmission
+ * is dropped (it usually ends with a STOP symbol instead of SYNC).
+ *
+ * @param protocols:     descriptors, the array must live as long as the parser
+ * @param protocols_num: number of descriptors, up to PD_PROTOCOLS_MAX
+ * @return
+ *      Handle of the parser or NULL
+ */
+parser_t *pd_parser_new(const pd_protocol_t *protocols, int protocols_num);
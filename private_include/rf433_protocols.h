@@ -0,0 +1,52 @@
+#pragma once
+
+#include "rf433_pulse_parser.h"
+#include "rf433_pd_parser.h"
+
+/*
+ Configurations of the pulse protocols supported by the driver.
+ Shared by the driver and the pulse train synthesizer, the synthesizer sends the codes with the symbols
+ of real transmitters, see synth_protocols.
+*/
+
+#define RF_PROTOCOL_EV1527 \
+    { .id = 0x1527, .sync_clk = 32, .bit_clk = 4, .code_bits_len = 24, .inverted = false }
+
+#define RF_PROTOCOL_2 \
+    { .id = 0x0002, .sync_clk = 11, .bit_clk = 3, .code_bits_len = 24, .inverted = false }
+
+#define RF_PROTOCOL_3 \
+    { .id = 0x0003, .sync_clk = 101, .bit_clk = 15, .code_bits_len = 24, .inverted = false }
+
+#define RF_PROTOCOL_4 \
+    { .id = 0x0004, .sync_clk = 7, .bit_clk = 4, .code_bits_len = 24, .inverted = false }
+
+#define RF_PROTOCOL_5 \
+    { .id = 0x0005, .sync_clk = 20, .bit_clk = 3, .code_bits_len = 24, .inverted = false }
+
+#define RF_PROTOCOL_HT6P20B \
+    { .id = 0x6B20, .sync_clk = 24, .bit_clk = 3, .code_bits_len = 24, .inverted = true }
+
+#define RF_PROTOCOL_HS2303_PT \
+    { .id = 0x2303, .sync_clk = 64, .bit_clk = 7, .code_bits_len = 24, .inverted = false }
+
+#define RF_PROTOCOL_1BYONE \
+    { .id = 0x01B1, .sync_clk = 17, .bit_clk = 4, .code_bits_len = 24, .inverted = true }
+
+#define RF_PROTOCOL_HT12E \
+    { .id = 0x012e, .sync_clk = 17, .bit_clk = 4, .code_bits_len = 24, .inverted = true }
+
+#define RF_PROTOCOL_SM5212 \
+    { .id = 0x5212, .sync_clk = 37, .bit_clk = 3, .code_bits_len = 24, .inverted = true }
+
+/*
+ Pulse distance protocols, see rf433_pd_parser.h.
+*/
+
+// King-Serry, see docs/king-serry.adoc. The bits are tested by width only, it works pretty well
+// taking into account huge signal drift.
+#define RF_PROTOCOL_KINGSERRY \
+    { .id = 0x0000, .code_bits_len = 40, \
+      .sync_start_us = {185, 215}, .sync_width_us = {780, 810}, \
+      .bit_start_0_us = PD_ANY_US, .bit_start_1_us = PD_ANY_US, \
+      .bit_width_0_us = {180, 230}, .bit_width_1_us = {370, 420} }
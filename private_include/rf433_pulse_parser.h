@@ -6,6 +6,8 @@
 #include <stdint.h>
 #include <esp_err.h>
 
+#define PULSE_BIT_TOLERANCE       4   // max deviation of bit width (percent) of a hard bit
+#define PULSE_SOFT_BIT_TOLERANCE  25  // max deviation of bit width (percent) of a soft bit, it is only voted
 
 typedef struct {
     uint16_t id;           // protocol ID
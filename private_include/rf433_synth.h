@@ -0,0 +1,161 @@
+#pragma once
+
+#include "rf433_types.h"
+#include "rf433_pulse_parser.h"
+#include "rf433_pd_parser.h"
+
+#include <stddef.h>
+#include <esp_err.h>
+
+/*
+ Pulse train synthesizer.
+
+ Produces the pulse sequence a transmitter would send, in the same form the ISR delivers it
+ to the parsers (alternating levels, widths in microseconds, time_us == 0 is a reset signal).
+ The result can be fed straight into parser_t::input to check the parsers without a radio.
+*/
+
+typedef struct {
+    pulse_t *pulses;
+    size_t len;            // number of pulses in the train
+    size_t size;           // number of allocated pulses
+} pulse_train_t;
+
+/*
+ Transmitters of the pulse protocols: symbols are pairs of pulses in clock ticks as RC Switch describes them.
+ The parsers know only the total widths of SYNC and bits, so the symbols of real transmitters
+ (e.g. {4, 11} and {9, 6} bits of Protocol 3) are not the parser's {1, clk - 1} model.
+*/
+
+typedef struct {
+    uint8_t first;         // ticks of the first pulse: HIGH, or LOW for inverted protocols
+    uint8_t second;        // ticks of the second pulse
+} synth_symbol_t;
+
+typedef struct {
+    const char *name;
+    pulse_parser_config_t config;  // protocol as passed to pulse_parser_new(), code_bits_len == 0 for King-Serry
+    int clock_us;          // width of one clock tick
+    synth_symbol_t sync;   // sent after the code bits
+    synth_symbol_t zero;
+    synth_symbol_t one;
+} synth_protocol_t;
+
+#define SYNTH_PROTOCOLS_NUM 11
+
+/*
+ Every protocol of the driver with the timings of its transmitters
+*/
+extern const synth_protocol_t synth_protocols[SYNTH_PROTOCOLS_NUM];
+
+typedef struct {
+    int skew_ppm;          // transmitter clock skew in ppm, positive values make pulses longer
+    int jitter_us;         // every pulse width is randomly changed within +- jitter_us
+    int duty_us;           // HIGH pulses are longer and LOW pulses are shorter by duty_us (duty cycle distortion)
+    int drop_edge_permille;// probability (per 1000 edges) that the receiver misses an edge
+    int noise_permille;    // probability (per 1000 pulses) of a glitch in the middle of a pulse
+    int noise_us;          // width of a glitch
+    uint32_t seed;         // seed of the pseudo random generator, same seed gives the same train
+} synth_impairments_t;
+
+/**
+ * @brief Create a new empty pulse train
+ *
+ * @param size: number of pulses to preallocate, the train grows when needed
+ * @return
+ *      Handle of the train or NULL
+ */
+pulse_train_t *synth_train_new(size_t size);
+
+/**
+ * @brief Free the pulse train
+ */
+void synth_train_free(pulse_train_t *train);
+
+/**
+ * @brief Remove all pulses from the train
+ */
+void synth_train_clear(pulse_train_t *train);
+
+/**
+ * @brief Append a pulse, it is merged with the last one if levels are the same
+ *
+ * @return
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t synth_pulse(pulse_train_t *train, int level, int time_us);
+
+/**
+ * @brief Append a reset signal (missed interrupt or full queue as the ISR reports it)
+ */
+esp_err_t synth_reset(pulse_train_t *train);
+
+/**
+ * @brief Append transmission of the code with a pulse protocol
+ *
+ * Each repeat is the code bits followed by SYNC, the way RC Switch compatible transmitters send it.
+ *
+ * @param protocol: transmitter of the protocol, e.g. one of synth_protocols
+ * @param code:     code to send, protocol->config.code_bits_len least significant bits are used
+ * @param repeats:  number of frames to send
+ * @return
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t synth_pulse_code(pulse_train_t *train, const synth_protocol_t *protocol, uint64_t code, int repeats);
+
+/**
+ * @brief Append transmission of the 40 bits code with King-Serry (NEC) protocol
+ *
+ * Each repeat is START followed by the code bits, transmission ends with STOP.
+ *
+ * @return
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t synth_nec_code(pulse_train_t *train, uint64_t code, int repeats);
+
+/**
+ * @brief Append transmission of the code with a descriptor of pulse distance parser
+ *
+ * Widths are in the middle of the descriptor's windows, the HIGH pulse of a bit which start is not
+ * limited (PD_ANY_US) is half of the bit. Each repeat is SYNC followed by the code bits, and SYNC
+ * of one more frame ends the transmission, so the parser reports the last repeat too.
+ *
+ * @param protocol: descriptor, e.g. RF_PROTOCOL_KINGSERRY
+ * @param code:     code to send, protocol->code_bits_len least significant bits are used
+ * @param repeats:  number of frames to send
+ * @return
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t synth_pd_code(pulse_train_t *train, const pd_protocol_t *protocol, uint64_t code, int repeats);
+
+/**
+ * @brief Mix two transmitters on air
+ *
+ * The receiver sees HIGH while at least one of the transmitters is sending HIGH.
+ *
+ * @param out:       train to append the result to
+ * @param offset_us: time when the second transmitter starts relative to the first one (can be negative)
+ * @return
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t synth_overlay(pulse_train_t *out, const pulse_train_t *a, const pulse_train_t *b, int64_t offset_us);
+
+/**
+ * @brief Apply clock skew, jitter, noise and missed edges to the train
+ *
+ * @param out: train to append the result to
+ * @param in:  clean train
+ * @return
+ *     - ESP_ERR_INVALID_ARG Parameter error
+ *     - ESP_ERR_NO_MEM Out of memory
+ *     - ESP_OK Success
+ */
+esp_err_t synth_impair(pulse_train_t *out, const pulse_train_t *in, const synth_impairments_t *impairments);
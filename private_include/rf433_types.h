@@ -14,6 +14,7 @@
 
 typedef struct {
     int level;
+    uint8_t receiver;     // index of the receiver in diversity mode
     int64_t time_us;
 } pulse_t;
 
@@ -27,6 +28,14 @@ typedef struct {
     int bits;
 } code_t;
 
+typedef struct {
+    int first_level;      // level of the first pulse of SYNC
+    range_t first_us;     // width of the first pulse
+    range_t second_us;    // width of the second pulse
+    range_t ratio;        // divint(second, first), or divint(first, second) if ratio_inverted
+    bool ratio_inverted;
+} sync_band_t;
+
 typedef struct parser_s parser_t;
 
 struct parser_s {
@@ -41,4 +50,46 @@ struct parser_s {
      *      true if a code parsed and event structure updated
      */
     bool (*input)(parser_t *parser, const pulse_t *pulse, rf_event_t *out_event);
+
+    /**
+     * @brief Get the next event happened on the same pulse
+     *
+     * Some parsers emit several events on one pulse, input() returns the first of them.
+     *
+     * @param parser:    Handle of the parser
+     * @param out_event: Fill the struct if there is one more event
+     *
+     * @return
+     *      true if event structure updated
+     */
+    bool (*next_event)(parser_t *parser, rf_event_t *out_event);
+
+    /**
+     * @brief Check the parser is looking for SYNC and no code sequence is in progress
+     *
+     * @param parser:    Handle of the parser
+     *
+     * @return
+     *      true if the parser can skip pulses that are not SYNC
+     */
+    bool (*is_idle)(parser_t *parser);
+
+    /**
+     * @brief Set the pulse preceding the next one without processing it
+     *
+     * Used to feed an idle parser only with pulse pairs that may be SYNC.
+     *
+     * @param parser:    Handle of the parser
+     * @param pulse:     Previous pulse
+     */
+    void (*prime)(parser_t *parser, const pulse_t *pulse);
+
+    /**
+     * @brief Free the parser
+     *
+     * @param parser:    Handle of the parser
+     */
+    void (*del)(parser_t *parser);
+
+    sync_band_t sync;     // any SYNC the parser accepts is within the band
 };
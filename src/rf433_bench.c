@@ -0,0 +1,326 @@
+#include "driver/rf_bench.h"
+#include "rf433_parser.h"
+#include "rf433_protocols.h"
+#include "rf433_dispatch.h"
+#include "rf433_synth.h"
+#include "rf433_utils.h"
+#include "rf433_bench_baseline.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char *TAG = "rf_bench";
+
+#define BENCH_PROTOCOLS   SYNTH_PROTOCOLS_NUM
+#define BENCH_REPEATS     5      // frames per code in the clean stream
+#define BENCH_NOISE_LEN   2048   // pulses in the noise stream
+#define BENCH_MIN_US      100000 // min time of a case, the stream is fed again and again
+#define BENCH_CALLS       100000 // calls of a function per case
+
+static const pd_protocol_t s_kingserry = RF_PROTOCOL_KINGSERRY;
+
+static const int s_task_sizes[] = {1, 4, BENCH_PROTOCOLS};  // the first protocols of synth_protocols
+
+#define BENCH_TASKS ((int) (sizeof(s_task_sizes) / sizeof(s_task_sizes[0])))
+
+typedef struct {
+    rf_bench_result_t *results;
+    size_t results_size;
+    size_t results_num;
+    bool failed;
+} bench_run_t;
+
+/**********************************************************************************
+ * Private Methods
+ **********************************************************************************/
+
+static inline uint32_t next_random(uint32_t *state) {  // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/*
+ * @brief Create a fresh parser of the protocol, so no state is carried between cases
+ */
+static parser_t *new_parser(int n) {
+    return synth_protocols[n].config.code_bits_len ?
+           pulse_parser_new(&synth_protocols[n].config) : pd_parser_new(&s_kingserry, 1);
+}
+
+static void delete_parsers(parser_t **parsers, int parsers_num) {
+    for (int n = 0; n < parsers_num; n++) {
+        parsers[n]->del(parsers[n]);
+    }
+}
+
+static esp_err_t append_noise(pulse_train_t *train, uint32_t *seed, int pulses_num) {
+    for (int n = 0; n < pulses_num; n++) {
+        // mostly short spikes and sometimes long gaps, like a receiver with AGC in silence
+        uint32_t r = next_random(seed);
+        int width = (r & 0x7) == 0 ? 50 + (int) (r >> 8) % 15000 : 20 + (int) (r >> 8) % 1000;
+        int level = train->len ? !train->pulses[train->len - 1].level : 0;
+        if (synth_pulse(train, level, width) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+/*
+ * @brief Codes of all protocols, optionally with noise between them
+ */
+static esp_err_t make_codes(pulse_train_t *train, int noise_pulses_num) {
+    uint32_t seed = 0x13579BDF;
+    synth_train_clear(train);
+    for (int n = 0; n < BENCH_PROTOCOLS; n++) {
+        uint64_t code = 0x5A3C96ULL + n;
+        esp_err_t err = synth_protocols[n].config.code_bits_len ?
+                        synth_pulse_code(train, &synth_protocols[n], code, BENCH_REPEATS) :
+                        synth_nec_code(train, 0x2F7702018CULL, BENCH_REPEATS);
+        if (err != ESP_OK || synth_pulse(train, 0, 20000) != ESP_OK ||
+            append_noise(train, &seed, noise_pulses_num) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t make_noise(pulse_train_t *train) {
+    uint32_t seed = 0x1F2E3D4C;
+    synth_train_clear(train);
+    return append_noise(train, &seed, BENCH_NOISE_LEN);
+}
+
+/*
+ * @brief Damaged codes of all protocols with noise between them
+ */
+static esp_err_t make_mixed(pulse_train_t *train, pulse_train_t *tmp) {
+    synth_impairments_t impairments = {
+            .skew_ppm = 5000,
+            .jitter_us = 30,
+            .drop_edge_permille = 5,
+            .noise_permille = 10,
+            .noise_us = 30,
+            .seed = 0x2468ACE1,
+    };
+    esp_err_t err = make_codes(tmp, BENCH_NOISE_LEN / BENCH_PROTOCOLS);
+    if (err == ESP_OK) {
+        err = synth_impair(train, tmp, &impairments);
+    }
+    return err;
+}
+
+/*
+ * @brief Compare the time with the baseline, on the linux target the host is shared with other jobs,
+ *        so the timings are for information only
+ */
+static inline bool is_slower(const rf_bench_result_t *result, const rf_bench_result_t *baseline) {
+#ifdef CONFIG_IDF_TARGET_LINUX
+    return false;
+#else
+    return baseline->ns_per_pulse != 0 &&
+           result->ns_per_pulse * 100 > baseline->ns_per_pulse * (100 + CONFIG_RF_MODULE_BENCHMARK_TOLERANCE);
+#endif
+}
+
+static void report(bench_run_t *run, const char *name, uint32_t pulses, int64_t elapsed_us, uint32_t events) {
+    rf_bench_result_t result = {
+            .pulses = pulses,
+            .ns_per_pulse = pulses ? (uint32_t) (elapsed_us * 1000 / pulses) : 0,
+            .pulses_per_sec = elapsed_us ? (uint32_t) ((int64_t) pulses * 1000000 / elapsed_us) : 0,
+            .events = events,
+    };
+    strncpy(result.name, name, RF_BENCH_NAME_LEN - 1);
+
+    const rf_bench_result_t *baseline = NULL;
+    for (size_t n = 0; n < sizeof(s_baseline) / sizeof(s_baseline[0]); n++) {
+        if (strcmp(s_baseline[n].name, result.name) == 0) {
+            baseline = &s_baseline[n];
+            break;
+        }
+    }
+    const char *status = "ok";
+    if (baseline == NULL) {
+        status = "new";
+    } else if (baseline->events != result.events) {
+        status = "changed";
+    } else if (is_slower(&result, baseline)) {
+        status = "slower";
+    }
+    if (baseline != NULL && strcmp(status, "ok") != 0) {
+        run->failed = true;
+    }
+    ESP_LOGI(TAG, "rf_bench,%s,%u,%u,%u,%u,%u,%u,%s", result.name, (unsigned) result.pulses,
+             (unsigned) result.ns_per_pulse, (unsigned) result.pulses_per_sec, (unsigned) result.events,
+             baseline ? (unsigned) baseline->ns_per_pulse : 0, baseline ? (unsigned) baseline->events : 0, status);
+
+    if (run->results != NULL && run->results_num < run->results_size) {
+        run->results[run->results_num++] = result;
+    }
+}
+
+/*
+ * @brief Feed the stream to a single parser
+ */
+static esp_err_t bench_parser(bench_run_t *run, int n, const pulse_train_t *train, const char *stream) {
+    rf_event_t event;
+    uint32_t events = 0, pulses = 0;
+
+    parser_t *parser = new_parser(n);
+    RF_CHECK(parser, "cannot create parser", ESP_ERR_NO_MEM);
+    int64_t start = esp_timer_get_time();
+    int64_t elapsed;
+    do {
+        for (size_t i = 0; i < train->len; i++) {
+            for (bool emitted = parser->input(parser, &train->pulses[i], &event); emitted;
+                 emitted = parser->next_event(parser, &event)) {
+                events += pulses < train->len;
+            }
+        }
+        pulses += train->len;
+        elapsed = esp_timer_get_time() - start;
+    } while (elapsed < BENCH_MIN_US);
+    parser->del(parser);
+
+    char name[RF_BENCH_NAME_LEN];
+    snprintf(name, sizeof(name), "%s/%s", synth_protocols[n].name, stream);
+    report(run, name, pulses, elapsed, events);
+    return ESP_OK;
+}
+
+static void count_event(int n, rf_event_t *event, void *arg) {
+    (*(uint32_t *) arg)++;
+}
+
+/*
+ * @brief Feed the stream to the parsers task loop (without queues)
+ */
+static esp_err_t bench_task(bench_run_t *run, int t, const pulse_train_t *train, const char *stream) {
+    parser_t *parsers[BENCH_PROTOCOLS];
+    dispatch_t dispatch;
+    dispatch_t *d = &dispatch;
+    uint32_t events = 0, repeated = 0, pulses = 0;
+
+    int parsers_num = 0;
+    for (; parsers_num < s_task_sizes[t]; parsers_num++) {
+        parsers[parsers_num] = new_parser(parsers_num);
+        if (parsers[parsers_num] == NULL) {
+            break;
+        }
+    }
+    if (parsers_num != s_task_sizes[t] || dispatch_init(d, parsers, parsers_num) != ESP_OK) {
+        ESP_LOGE(TAG, "cannot create parsers task");
+        delete_parsers(parsers, parsers_num);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int64_t elapsed;
+    do {
+        uint32_t *counter = pulses < train->len ? &events : &repeated;
+        for (size_t i = 0; i < train->len; i++) {
+            dispatch_pulse(d, &train->pulses[i], count_event, counter);
+        }
+        pulses += train->len;
+        elapsed = esp_timer_get_time() - start;
+    } while (elapsed < BENCH_MIN_US);
+    dispatch_deinit(d);
+    delete_parsers(parsers, parsers_num);
+
+    char name[RF_BENCH_NAME_LEN];
+    snprintf(name, sizeof(name), "task%d/%s", s_task_sizes[t], stream);
+    report(run, name, pulses, elapsed, events);
+    return ESP_OK;
+}
+
+/*
+ * @brief Benchmark the functions shared by parsers
+ */
+static void bench_runtime(bench_run_t *run, const pulse_train_t *train) {
+    parser_runtime_t runtime;
+    rf_event_t event;
+    uint32_t events = 0;
+
+    init(&runtime, (parser_runtime_config_t) {.protocol_id = 0x1527, .code_bits_len = 24, .inverted = false});
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        switch (next_pulse(&runtime, &train->pulses[i % train->len])) {
+            case ParserDoReset:
+                reset(&runtime, NULL);
+                break;
+            default:
+                break;
+        }
+    }
+    report(run, "next_pulse", BENCH_CALLS, esp_timer_get_time() - start, 0);
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        runtime.codes_num = i & 1;  // every other call emits STOP
+        events += reset(&runtime, &event);
+    }
+    report(run, "reset", BENCH_CALLS, esp_timer_get_time() - start, events);
+
+    events = 0;
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < BENCH_CALLS; i++) {
+        runtime.captured.bits = 24;
+        runtime.captured.data = i >> 3;  // a new code every 8 calls
+        events += register_code(&runtime, &event);
+    }
+    report(run, "register_code", BENCH_CALLS, esp_timer_get_time() - start, events);
+}
+
+static esp_err_t bench_stream(bench_run_t *run, const pulse_train_t *train, const char *stream) {
+    esp_err_t err = ESP_OK;
+    for (int n = 0; n < BENCH_PROTOCOLS && err == ESP_OK; n++) {
+        err = bench_parser(run, n, train, stream);
+    }
+    for (int t = 0; t < BENCH_TASKS && err == ESP_OK; t++) {
+        err = bench_task(run, t, train, stream);
+    }
+    return err;
+}
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+esp_err_t rf_bench_run(rf_bench_result_t *results, size_t *results_num) {
+    RF_CHECK(results == NULL || results_num != NULL, "results number can't be null", ESP_ERR_INVALID_ARG);
+
+    bench_run_t run = {
+            .results = results,
+            .results_size = results ? *results_num : 0,
+    };
+    pulse_train_t *train = synth_train_new(0);
+    pulse_train_t *tmp = synth_train_new(0);
+    esp_err_t err = ESP_ERR_NO_MEM;
+    if (train == NULL || tmp == NULL) {
+        goto out;
+    }
+
+    ESP_LOGI(TAG, "rf_bench,name,pulses,ns_per_pulse,pulses_per_sec,events,baseline_ns,baseline_events,status");
+    if ((err = make_codes(train, 0)) != ESP_OK) goto out;
+    bench_runtime(&run, train);
+    if ((err = bench_stream(&run, train, "clean")) != ESP_OK) goto out;
+    if ((err = make_noise(train)) != ESP_OK) goto out;
+    if ((err = bench_stream(&run, train, "noise")) != ESP_OK) goto out;
+    if ((err = make_mixed(train, tmp)) != ESP_OK) goto out;
+    if ((err = bench_stream(&run, train, "mixed")) != ESP_OK) goto out;
+
+    err = run.failed ? ESP_FAIL : ESP_OK;
+out:
+    synth_train_free(train);
+    synth_train_free(tmp);
+    if (results_num != NULL) {
+        *results_num = run.results_num;
+    }
+    return err;
+}
@@ -0,0 +1,160 @@
+#include "rf433_codes.h"
+#include "rf433_utils.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+
+static const char *TAG = "rf_codes";
+
+/**********************************************************************************
+ * Private Methods
+ **********************************************************************************/
+
+static inline uint32_t hash(uint16_t protocol, uint8_t bits, uint64_t raw_code) {
+    // splitmix64 finalizer
+    uint64_t x = raw_code ^ ((uint64_t) protocol << 48) ^ ((uint64_t) bits << 40);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return (uint32_t) x;
+}
+
+static inline bool is_key(const code_entry_t *entry, uint16_t protocol, uint8_t bits, uint64_t raw_code) {
+    return entry->raw_code == raw_code && entry->protocol == protocol && entry->bits == bits;
+}
+
+/*
+ * @brief Find the slot of the code or the empty slot where it must be placed
+ */
+static inline uint32_t find_slot(const code_table_t *t, uint16_t protocol, uint8_t bits, uint64_t raw_code) {
+    uint32_t n = hash(protocol, bits, raw_code) & t->mask;
+    while (t->entries[n].used && !is_key(&t->entries[n], protocol, bits, raw_code)) {
+        n = (n + 1) & t->mask;
+    }
+    return n;
+}
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+code_table_t *code_table_new(size_t max_count) {
+    RF_CHECK(max_count > 0, "table size can't be zero", NULL);
+
+    uint32_t slots = 4;
+    while (slots < max_count + max_count / 3 + 1) {
+        slots <<= 1;
+    }
+
+    code_table_t *table = malloc(sizeof(code_table_t));
+    RF_CHECK(table, "cannot allocate memory for code_table_t", NULL);
+
+    table->entries = calloc(slots, sizeof(code_entry_t));
+    if (table->entries == NULL) {
+        ESP_LOGE(TAG, "cannot allocate memory for %" PRIu32 " codes", slots);
+        free(table);
+        return NULL;
+    }
+    table->mask = slots - 1;
+    table->count = 0;
+    table->max_count = max_count;
+    return table;
+}
+
+void code_table_free(code_table_t *table) {
+    if (table != NULL) {
+        free(table->entries);
+        free(table);
+    }
+}
+
+esp_err_t code_table_put(code_table_t *table, const rf_code_t *code) {
+    uint32_t n = find_slot(table, code->protocol, code->bits, code->raw_code);
+    code_entry_t *entry = &table->entries[n];
+    if (!entry->used) {
+        if (table->count == table->max_count) {
+            return ESP_ERR_NO_MEM;
+        }
+        entry->raw_code = code->raw_code;
+        entry->protocol = code->protocol;
+        entry->bits = code->bits;
+        entry->used = 1;
+        table->count++;
+    }
+    entry->tag = code->tag;
+    return ESP_OK;
+}
+
+bool code_table_get(const code_table_t *table, uint16_t protocol, uint8_t bits, uint64_t raw_code, uint32_t *tag) {
+    const code_entry_t *entry = &table->entries[find_slot(table, protocol, bits, raw_code)];
+    if (!entry->used) {
+        return false;
+    }
+    if (tag != NULL) {
+        *tag = entry->tag;
+    }
+    return true;
+}
+
+bool code_table_remove(code_table_t *table, uint16_t protocol, uint8_t bits, uint64_t raw_code) {
+    uint32_t hole = find_slot(table, protocol, bits, raw_code);
+    if (!table->entries[hole].used) {
+        return false;
+    }
+    // backward shift deletion: move up entries of the cluster which can't be found otherwise
+    uint32_t n = hole;
+    for (;;) {
+        n = (n + 1) & table->mask;
+        code_entry_t *entry = &table->entries[n];
+        if (!entry->used) {
+            break;
+        }
+        uint32_t home = hash(entry->protocol, entry->bits, entry->raw_code) & table->mask;
+        // move the entry if its home slot is not within (hole, n] cyclically
+        if (((n - home) & table->mask) >= ((n - hole) & table->mask)) {
+            table->entries[hole] = *entry;
+            hole = n;
+        }
+    }
+    table->entries[hole].used = 0;
+    table->count--;
+    return true;
+}
+
+void code_table_clear(code_table_t *table) {
+    memset(table->entries, 0, (table->mask + 1) * sizeof(code_entry_t));
+    table->count = 0;
+}
+
+void code_filter_init(code_filter_t *filter, size_t sample) {
+    memset(filter, 0, sizeof(code_filter_t));
+    filter->sample = sample;
+}
+
+bool code_filter_pass(code_filter_t *filter, const code_table_t *table, rf_event_t *event) {
+    if (code_table_get(table, event->protocol, event->bits, event->raw_code, &event->tag)) {
+        return true;
+    }
+    code_filter_protocol_t *p = NULL;
+    for (size_t n = 0; n < filter->protocols_num && p == NULL; n++) {
+        if (filter->protocols[n].protocol == event->protocol) {
+            p = &filter->protocols[n];
+        }
+    }
+    if (p == NULL) {
+        if (event->action != RF_ACTION_START || filter->protocols_num == CODE_FILTER_PROTOCOLS_MAX) {
+            return false;
+        }
+        p = &filter->protocols[filter->protocols_num++];
+        p->protocol = event->protocol;
+    }
+    // sample whole sequences, so START, CONTINUE and STOP of unknown code come together
+    if (event->action == RF_ACTION_START) {
+        p->sampled = filter->sample != 0 && (filter->unknown_num++ % filter->sample) == 0;
+    }
+    return p->sampled;
+}
@@ -0,0 +1,128 @@
+#include "rf433_dispatch.h"
+#include "rf433_utils.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <esp_log.h>
+
+static const char *TAG = "rf_dispatch";
+
+/**********************************************************************************
+ * Private Methods
+ **********************************************************************************/
+
+/*
+ * @brief Quantize the width: 4 bins per octave
+ */
+static inline int width_bin(int64_t width_us) {
+    if (width_us < (1 << DISPATCH_OCTAVE_MIN)) {
+        return 0;
+    }
+    if (width_us >= (1 << (DISPATCH_OCTAVE_MIN + DISPATCH_OCTAVES))) {
+        return DISPATCH_BINS - 1;
+    }
+    int octave = 31 - __builtin_clz((uint32_t) width_us);
+    int sub = (int) (width_us >> (octave - 2)) & 0x3;
+    return (octave - DISPATCH_OCTAVE_MIN) * DISPATCH_BINS_PER_OCTAVE + sub;
+}
+
+static inline void bin_range(int bin, range_t *range) {
+    int octave = DISPATCH_OCTAVE_MIN + bin / DISPATCH_BINS_PER_OCTAVE;
+    int sub = bin % DISPATCH_BINS_PER_OCTAVE;
+    range->min = bin == 0 ? 0 : (4 + sub) << (octave - 2);
+    range->max = bin == DISPATCH_BINS - 1 ? INT_MAX : ((5 + sub) << (octave - 2)) - 1;
+}
+
+static inline bool is_overlapped(const range_t *a, const range_t *b) {
+    return a->min <= b->max && b->min <= a->max;
+}
+
+/*
+ * @brief Check that some pair of widths within the bins can be SYNC of the band
+ */
+static bool may_be_sync(const sync_band_t *band, const range_t *first, const range_t *second) {
+    if (!is_overlapped(first, &band->first_us) || !is_overlapped(second, &band->second_us)) {
+        return false;
+    }
+    // bounds of the ratio over the cell, wide enough to cover rounding of divint()
+    const range_t *num = band->ratio_inverted ? first : second;
+    const range_t *den = band->ratio_inverted ? second : first;
+    range_t ratio = {
+            .min = den->max == INT_MAX ? 0 : num->min / (den->max + 1),
+            .max = (den->min == 0 || num->max == INT_MAX) ? INT_MAX : num->max / den->min + 1,
+    };
+    return is_overlapped(&ratio, &band->ratio);
+}
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+esp_err_t dispatch_init(dispatch_t *d, parser_t **parsers, int parsers_num) {
+    RF_CHECK(parsers_num <= DISPATCH_PARSERS_MAX, "too many parsers", ESP_ERR_INVALID_ARG);
+
+    d->candidates = calloc(DISPATCH_BINS * DISPATCH_BINS, sizeof(parsers_mask_t));
+    RF_CHECK(d->candidates, "cannot allocate memory for candidates table", ESP_ERR_NO_MEM);
+
+    d->parsers = parsers;
+    d->parsers_num = parsers_num;
+    d->active = 0;
+    d->first_level[0] = 0;
+    d->first_level[1] = 0;
+    d->last_pulse.time_us = 0;
+
+    for (int n = 0; n < parsers_num; n++) {
+        const sync_band_t *band = &parsers[n]->sync;
+        d->first_level[band->first_level ? 1 : 0] |= 1U << n;
+
+        range_t first, second;
+        for (int f = 0; f < DISPATCH_BINS; f++) {
+            bin_range(f, &first);
+            for (int s = 0; s < DISPATCH_BINS; s++) {
+                bin_range(s, &second);
+                if (may_be_sync(band, &first, &second)) {
+                    d->candidates[f * DISPATCH_BINS + s] |= 1U << n;
+                }
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+void dispatch_deinit(dispatch_t *d) {
+    free(d->candidates);
+    d->candidates = NULL;
+}
+
+parsers_mask_t IRAM_ATTR dispatch_select(dispatch_t *d, const pulse_t *pulse) {
+    parsers_mask_t mask = d->active;
+    if (pulse->time_us == 0) {  // reset signal concerns only parsers in progress
+        d->last_pulse.time_us = 0;
+        return mask;
+    }
+
+    const pulse_t *last = &d->last_pulse;
+    if (last->time_us != 0) {
+        parsers_mask_t idle = d->candidates[width_bin(last->time_us) * DISPATCH_BINS + width_bin(pulse->time_us)] &
+                              d->first_level[last->level ? 1 : 0] & ~d->active;
+        for (parsers_mask_t m = idle; m != 0; m &= m - 1) {
+            parser_t *parser = d->parsers[__builtin_ctz(m)];
+            parser->prime(parser, last);
+        }
+        mask |= idle;
+    }
+    d->last_pulse = *pulse;
+    return mask;
+}
+
+void IRAM_ATTR dispatch_pulse(dispatch_t *d, const pulse_t *pulse, dispatch_handler_t handler, void *arg) {
+    rf_event_t event;
+    for (parsers_mask_t mask = dispatch_select(d, pulse); mask != 0; mask &= mask - 1) {
+        int n = __builtin_ctz(mask);
+        parser_t *parser = d->parsers[n];
+        for (bool emitted = parser->input(parser, pulse, &event); emitted; emitted = parser->next_event(parser, &event)) {
+            handler(n, &event, arg);
+        }
+        dispatch_update(d, n);
+    }
+}
@@ -0,0 +1,149 @@
+#include "rf433_diversity.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <esp_log.h>
+
+static const char *TAG = "rf_diversity";
+
+/**********************************************************************************
+ * Private Methods
+ **********************************************************************************/
+
+static inline bool is_key(const diversity_slot_t *slot, const rf_event_t *event) {
+    return slot->raw_code == event->raw_code && slot->protocol == event->protocol && slot->bits == event->bits;
+}
+
+static diversity_slot_t *find_slot(diversity_t *d, const rf_event_t *event) {
+    for (int n = 0; n < DIVERSITY_SLOTS; n++) {
+        if (d->slots[n].used && is_key(&d->slots[n], event)) {
+            return &d->slots[n];
+        }
+    }
+    return NULL;
+}
+
+static diversity_slot_t *new_slot(diversity_t *d, int receiver, int parser, const rf_event_t *event, int64_t now_us) {
+    for (int n = 0; n < DIVERSITY_SLOTS; n++) {
+        diversity_slot_t *slot = &d->slots[n];
+        if (!slot->used) {
+            *slot = (diversity_slot_t) {
+                    .raw_code = event->raw_code,
+                    .last_us = now_us,
+                    .protocol = event->protocol,
+                    .bits = event->bits,
+                    .parser = parser,
+                    .receivers = 1U << receiver,
+                    .heard = 1U << receiver,
+                    .leader = receiver,
+                    .used = true,
+            };
+            slot->heard_us[receiver] = now_us;
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * @brief The receiver finished the sequence
+ */
+static void leave_slot(diversity_slot_t *slot, int receiver, int64_t now_us) {
+    slot->receivers &= ~(1U << receiver);
+    if (slot->receivers == 0) {
+        slot->last_us = now_us;  // STOP is pending until the window is over
+    } else if (slot->leader == receiver) {
+        slot->leader = __builtin_ctz(slot->receivers);
+    }
+}
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+void diversity_init(diversity_t *d, int64_t window_us) {
+    memset(d->slots, 0, sizeof(d->slots));
+    d->window_us = window_us;
+}
+
+bool diversity_input(diversity_t *d, int receiver, int parser, rf_event_t *event, int64_t now_us) {
+    diversity_slot_t *slot = find_slot(d, event);
+
+    if (event->action == RF_ACTION_STOP) {
+        if (slot != NULL && (slot->receivers & (1U << receiver))) {
+            leave_slot(slot, receiver, now_us);
+        }
+        return false;
+    }
+
+    if (event->action == RF_ACTION_START) {
+        // START of a new code ends the receiver's previous sequence of the parser
+        for (int n = 0; n < DIVERSITY_SLOTS; n++) {
+            diversity_slot_t *s = &d->slots[n];
+            if (s != slot && s->used && s->parser == parser && (s->receivers & (1U << receiver))) {
+                leave_slot(s, receiver, now_us);
+            }
+        }
+    }
+
+    if (slot == NULL) {
+        // the earliest receiver starts the sequence
+        slot = new_slot(d, receiver, parser, event, now_us);
+        if (slot == NULL) {
+            // the sequence starts when a slot is free, STOP of the dropped one is not expected
+            ESP_LOGW(TAG, "too many codes at once, event of code 0x%" PRIx64 " is dropped", event->raw_code);
+            return false;
+        }
+        event->action = RF_ACTION_START;
+        return true;
+    }
+
+    // events of one receiver are different frames, the shortest time between them is the frame period
+    if (slot->heard & (1U << receiver)) {
+        int64_t period_us = now_us - slot->heard_us[receiver];
+        if (slot->period_us == 0 || period_us < slot->period_us) {
+            slot->period_us = period_us;
+        }
+    }
+    slot->heard |= 1U << receiver;
+    slot->heard_us[receiver] = now_us;
+
+    bool resumed = slot->receivers == 0;  // all receivers stopped but the window is not over yet
+    bool new_frame = slot->period_us ? now_us - slot->last_us > slot->period_us / 2 : slot->leader == receiver;
+    slot->receivers |= 1U << receiver;
+    if (resumed || new_frame || now_us - slot->last_us > d->window_us) {
+        // the first receiver of the frame or the other receiver fills the gap
+        slot->leader = receiver;
+        slot->last_us = now_us;
+        event->action = RF_ACTION_CONTINUE;
+        return true;
+    }
+    return false;
+}
+
+bool diversity_flush(diversity_t *d, int64_t now_us, rf_event_t *event, int *parser) {
+    for (int n = 0; n < DIVERSITY_SLOTS; n++) {
+        diversity_slot_t *slot = &d->slots[n];
+        if (slot->used && slot->receivers == 0 && now_us - slot->last_us >= d->window_us) {
+            event->action = RF_ACTION_STOP;
+            event->raw_code = slot->raw_code;
+            event->protocol = slot->protocol;
+            event->bits = slot->bits;
+            event->tag = 0;
+            event->confidence = 100;
+            *parser = slot->parser;
+            slot->used = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool diversity_pending(const diversity_t *d) {
+    for (int n = 0; n < DIVERSITY_SLOTS; n++) {
+        if (d->slots[n].used && d->slots[n].receivers == 0) {
+            return true;
+        }
+    }
+    return false;
+}
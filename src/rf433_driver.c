@@ -1,11 +1,18 @@
 #include "driver/rf_receiver.h"
 #include "rf433_types.h"
 #include "rf433_pulse_parser.h"
-#include "rf433_nec_parser.h"
+#include "rf433_protocols.h"
+#include "rf433_codes.h"
+#include "rf433_dispatch.h"
+#include "rf433_events.h"
+#include "rf433_learn.h"
+#include "rf433_diversity.h"
+#include "rf433_pd_parser.h"
 
 #include <string.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
 #include <driver/gpio.h>
 #include <esp_timer.h>
 #include <esp_log.h>
@@ -18,79 +25,164 @@ static const char *TAG = "rf433";
         return (ret_val);                                         \
     }
 
-static gpio_num_t s_gpio_num = GPIO_NUM_NC;
+#define RF_RECEIVERS_MAX 2
+
+static gpio_num_t s_gpio_num[RF_RECEIVERS_MAX] = {GPIO_NUM_NC, GPIO_NUM_NC};
+static int s_receivers_num = 1;
+static int64_t s_diversity_window_us = 0;
+static diversity_t s_diversity;
 static size_t s_pulses_queue_size = 256;
 static size_t s_events_queue_size = 5;
 static QueueHandle_t s_pulses_queue = NULL;
 static QueueHandle_t s_events_queue = NULL;
 static UBaseType_t s_parser_task_priority = 10;
 static uint8_t s_events_mask = RF_EVENT_START | RF_EVENT_CONTINUE | RF_EVENT_STOP;
+static size_t s_codes_table_size = 0;
+static size_t s_unknown_codes_sample = 0;
+static code_table_t *s_codes = NULL;
+static code_filter_t s_codes_filter;
+static SemaphoreHandle_t s_codes_lock = NULL;
+static size_t s_events_ring_size = 0;
+static events_ring_t *s_events_ring = NULL;
+static SemaphoreHandle_t s_learn_lock = NULL;
+static pulse_t *s_learn_pulses = NULL;  // not NULL while learning
+static size_t s_learn_pulses_size = 0;
+static size_t s_learn_pulses_num = 0;
+
+// pulse distance protocols share one parser, it is created when any of them is enabled
+#if defined(CONFIG_RF_MODULE_PROTOCOL_KINGSERRY)
+#define RF_PD_PARSER_ENABLED
+#endif
 
-static parser_t *parsers[] = {
+enum {  // indexes of enabled protocols parsers
 #ifdef CONFIG_RF_MODULE_PROTOCOL_EV1527
-        NULL,
+        RF_PARSER_EV1527,
 #endif
-#ifdef CONFIG_RF_MODULE_PROTOCOL_KINGSERRY
-        NULL,
+#ifdef RF_PD_PARSER_ENABLED
+        RF_PARSER_PULSE_DISTANCE,  // one parser for all pulse distance protocols
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_2
-        NULL,
+        RF_PARSER_2,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_3
-        NULL,
+        RF_PARSER_3,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_4
-        NULL,
+        RF_PARSER_4,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_5
-        NULL,
+        RF_PARSER_5,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_HT6P20B
-        NULL,
+        RF_PARSER_HT6P20B,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_HS2303_PT
-        NULL,
+        RF_PARSER_HS2303_PT,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_1BYONE
-        NULL,
+        RF_PARSER_1BYONE,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_HT12E
-        NULL,
+        RF_PARSER_HT12E,
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_SM5212
-        NULL,
+        RF_PARSER_SM5212,
 #endif
+        RF_PARSERS_MAX
 };
+#ifdef RF_PD_PARSER_ENABLED
+static const pd_protocol_t s_pd_protocols[] = {  // evaluated together by one parser
+#ifdef CONFIG_RF_MODULE_PROTOCOL_KINGSERRY
+        RF_PROTOCOL_KINGSERRY,
+#endif
+};
+#endif
+static parser_t *parsers[RF_RECEIVERS_MAX][RF_PARSERS_MAX];
 static int parsers_num = 0;
+static dispatch_t s_dispatch[RF_RECEIVERS_MAX];
 
 /*****************************************************************************
  * Task for parsing pulses from RF module
  *****************************************************************************/
 
+/*
+ * @brief Check the event's code against known codes table and set the event's tag
+ *
+ * @return
+ *      true if the event must be sent
+ */
+static inline bool filter_event(rf_event_t *event) {
+    if (s_codes == NULL) {
+        return true;
+    }
+    xSemaphoreTake(s_codes_lock, portMAX_DELAY);
+    bool pass = code_filter_pass(&s_codes_filter, s_codes, event);
+    xSemaphoreGive(s_codes_lock);
+    return pass;
+}
+
+static inline void learn_pulse(const pulse_t *pulse) {
+    xSemaphoreTake(s_learn_lock, portMAX_DELAY);
+    if (s_learn_pulses != NULL && s_learn_pulses_num < s_learn_pulses_size) {
+        s_learn_pulses[s_learn_pulses_num++] = *pulse;
+    }
+    xSemaphoreGive(s_learn_lock);
+}
+
+static void send_event(rf_event_t *event) {
+    static bool queue_full = false;
+
+    // filter every event, a masked START still decides on sampling of the sequence
+    if (!filter_event(event) || !(s_events_mask & BIT(event->action))) {
+        return;
+    }
+    if (s_events_ring != NULL) {
+        events_ring_write(s_events_ring, event);
+        return;
+    }
+    UBaseType_t res = xQueueSend(s_events_queue, event, 500 / portTICK_PERIOD_MS);
+    if (res == pdFALSE) {
+        if (!queue_full) {
+            ESP_LOGE(TAG, "events queue is full");
+        }
+        queue_full = true;
+    } else {
+        queue_full = false;
+    }
+}
+
+/*
+ * @brief Event of the parser n of the receiver passed in arg
+ */
+static void IRAM_ATTR handle_event(int n, rf_event_t *event, void *arg) {
+    int receiver = (int) (intptr_t) arg;
+    if (s_receivers_num == 1 || diversity_input(&s_diversity, receiver, n, event, esp_timer_get_time())) {
+        send_event(event);
+    }
+}
+
 static void IRAM_ATTR rf_parser_task(void *arg) {
     ESP_LOGI(TAG, "start parsers task");
 
     pulse_t pulse;
     rf_event_t event;
-    bool queue_full = false;
     for (;;) {
-        if (xQueueReceive(s_pulses_queue, &pulse, portMAX_DELAY)) {
-            // feed pulses to protocol parsers
-            for (int n = 0; n < parsers_num; n++) {
-                if (parsers[n]->input(parsers[n], &pulse, &event)) {
-                    if (!(s_events_mask & BIT(event.action))) {
-                        continue;
-                    }
-                    UBaseType_t res = xQueueSend(s_events_queue, &event, 500 / portTICK_PERIOD_MS);
-                    if (res == pdFALSE) {
-                        if (!queue_full) {
-                            ESP_LOGE(TAG, "events queue is full");
-                        }
-                        queue_full = true;
-                    } else {
-                        queue_full = false;
-                    }
-                }
+        // wake up to send pending STOP events when the diversity window is over
+        TickType_t ticks_to_wait = portMAX_DELAY;
+        if (s_receivers_num > 1 && diversity_pending(&s_diversity)) {
+            ticks_to_wait = s_diversity_window_us / 1000 / portTICK_PERIOD_MS + 1;
+        }
+        if (xQueueReceive(s_pulses_queue, &pulse, ticks_to_wait)) {
+            if (s_learn_pulses != NULL && pulse.receiver == 0) {
+                learn_pulse(&pulse);
+            }
+            // feed pulses to protocol parsers that are in progress or may get SYNC
+            dispatch_pulse(&s_dispatch[pulse.receiver], &pulse, handle_event, (void *) (intptr_t) pulse.receiver);
+        }
+        if (s_receivers_num > 1) {
+            int n;
+            while (diversity_flush(&s_diversity, esp_timer_get_time(), &event, &n)) {
+                send_event(&event);
             }
         }
     }
@@ -102,34 +194,38 @@ static void IRAM_ATTR rf_parser_task(void *arg) {
  *****************************************************************************/
 
 static void IRAM_ATTR rf_isr_handler(void *arg) {
-    static pulse_t prev;
-    static bool queue_full = false;
+    static pulse_t prevs[RF_RECEIVERS_MAX];
+    static bool queues_full[RF_RECEIVERS_MAX];
+
+    int receiver = (int) (intptr_t) arg;
+    pulse_t *prev = &prevs[receiver];
+    bool *queue_full = &queues_full[receiver];
 
     pulse_t now = {
             .time_us = esp_timer_get_time(),
-            .level = gpio_get_level(s_gpio_num),  // get level of next pulse because we measure AFTER edge!
+            .level = gpio_get_level(s_gpio_num[receiver]),  // get level of next pulse because we measure AFTER edge!
     };
 
-    pulse_t pulse;
-    if (queue_full || (now.level == prev.level)) {
+    pulse_t pulse = {.receiver = receiver};
+    if (*queue_full || (now.level == prev->level)) {
         // we probably missed some interrupts; reset all parsers
         pulse.time_us = 0;
     } else {
-        pulse.level = prev.level;
-        pulse.time_us = now.time_us - prev.time_us;
+        pulse.level = prev->level;
+        pulse.time_us = now.time_us - prev->time_us;
     }
 
     BaseType_t hp_task_awoken;
     BaseType_t res = xQueueSendFromISR(s_pulses_queue, &pulse, &hp_task_awoken);
     if (res == pdFALSE) {
-        if (!queue_full) { // report only once
+        if (!*queue_full) { // report only once
             ESP_EARLY_LOGE(TAG, "pulses queue is full");
         }
-        queue_full = true;
+        *queue_full = true;
     } else {
-        queue_full = false;
+        *queue_full = false;
     }
-    prev = now;
+    *prev = now;
 
     if (hp_task_awoken) {
         portYIELD_FROM_ISR();
@@ -142,14 +238,145 @@ static void IRAM_ATTR rf_isr_handler(void *arg) {
 
 esp_err_t rf_get_events_handle(QueueHandle_t *events) {
     RF_CHECK(events != NULL, "queue address error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(s_events_ring == NULL, "events are sent to the events ring", ESP_ERR_INVALID_STATE);
     *events = s_events_queue;
     return ESP_OK;
 }
 
-esp_err_t rf_set_pin(gpio_num_t gpio_num) {
+esp_err_t rf_events_reader_new(rf_events_reader_handle_t *reader) {
+    RF_CHECK(reader != NULL, "reader address error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(s_events_ring != NULL, "events ring is not enabled", ESP_ERR_INVALID_STATE);
+
+    *reader = events_ring_reader_new(s_events_ring);
+    return *reader != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t rf_events_reader_delete(rf_events_reader_handle_t reader) {
+    RF_CHECK(reader != NULL, "reader handle error", ESP_ERR_INVALID_ARG);
+    events_ring_reader_delete(reader);
+    return ESP_OK;
+}
+
+esp_err_t rf_events_read(rf_events_reader_handle_t reader, rf_event_t *event, uint32_t *missed,
+                         TickType_t ticks_to_wait) {
+    RF_CHECK(reader != NULL, "reader handle error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(event != NULL, "event address error", ESP_ERR_INVALID_ARG);
+    return events_ring_read(reader, event, missed, ticks_to_wait);
+}
+
+esp_err_t rf_events_reader_lag(rf_events_reader_handle_t reader, uint32_t *lag) {
+    RF_CHECK(reader != NULL, "reader handle error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(lag != NULL, "lag address error", ESP_ERR_INVALID_ARG);
+    *lag = events_ring_lag(reader);
+    return ESP_OK;
+}
+
+esp_err_t rf_learn_start(size_t pulses_num) {
+    RF_CHECK(s_learn_lock != NULL, "driver is not installed", ESP_ERR_INVALID_STATE);
+
+    if (pulses_num == 0) {
+        pulses_num = 1024;
+    }
+    pulse_t *pulses = malloc(pulses_num * sizeof(pulse_t));
+    RF_CHECK(pulses, "cannot allocate memory for pulses", ESP_ERR_NO_MEM);
+
+    xSemaphoreTake(s_learn_lock, portMAX_DELAY);
+    bool started = s_learn_pulses != NULL;
+    if (!started) {
+        s_learn_pulses_size = pulses_num;
+        s_learn_pulses_num = 0;
+        s_learn_pulses = pulses;
+    }
+    xSemaphoreGive(s_learn_lock);
+    if (started) {
+        free(pulses);
+    }
+    RF_CHECK(!started, "learning is already started", ESP_ERR_INVALID_STATE);
+    return ESP_OK;
+}
+
+esp_err_t rf_learn_stop(rf_learned_protocol_t *protocol) {
+    RF_CHECK(protocol != NULL, "protocol address error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(s_learn_lock != NULL, "driver is not installed", ESP_ERR_INVALID_STATE);
+
+    xSemaphoreTake(s_learn_lock, portMAX_DELAY);
+    pulse_t *pulses = s_learn_pulses;
+    size_t pulses_num = s_learn_pulses_num;
+    s_learn_pulses = NULL;
+    xSemaphoreGive(s_learn_lock);
+    RF_CHECK(pulses != NULL, "learning is not started", ESP_ERR_INVALID_STATE);
+
+    esp_err_t err = learn_analyze(pulses, pulses_num, protocol);
+    free(pulses);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "no protocol found in %d pulses", pulses_num);
+        return err;
+    }
+
+    // print the learned protocol as initializer of the parser's configuration
+    const rf_learned_protocol_t *p = protocol;
+    if (p->encoding == RF_ENCODING_PULSE_WIDTH) {
+        pulse_parser_config_t c;
+        learn_pulse_config(p, &c);
+        ESP_LOGI(TAG, "learned: { .sync_clk = %d, .bit_clk = %d, .code_bits_len = %d, .inverted = %s } "
+                      "clock: %dus, sync: +-%d%%, bit: +-%d%%, code: 0x%llx, frames: %d",
+                 c.sync_clk, c.bit_clk, c.code_bits_len, c.inverted ? "true" : "false",
+                 p->clock_us, p->sync_tolerance, p->bit_tolerance, p->raw_code, p->frames);
+    } else {
+        pd_protocol_t d;
+        learn_pd_protocol(p, &d);
+        ESP_LOGI(TAG, "learned: { .code_bits_len = %d, .sync_start_us = {%d, %d}, .sync_width_us = {%d, %d}, "
+                      ".bit_start_0_us = {%d, %d}, .bit_start_1_us = {%d, %d}, "
+                      ".bit_width_0_us = {%d, %d}, .bit_width_1_us = {%d, %d} } code: 0x%llx, frames: %d",
+                 d.code_bits_len, d.sync_start_us.min, d.sync_start_us.max, d.sync_width_us.min, d.sync_width_us.max,
+                 d.bit_start_0_us.min, d.bit_start_0_us.max, d.bit_start_1_us.min, d.bit_start_1_us.max,
+                 d.bit_width_0_us.min, d.bit_width_0_us.max, d.bit_width_1_us.min, d.bit_width_1_us.max,
+                 p->raw_code, p->frames);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rf_codes_add(const rf_code_t *codes, size_t codes_num) {
+    RF_CHECK(codes != NULL || codes_num == 0, "codes address error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(s_codes != NULL, "known codes table is not enabled", ESP_ERR_INVALID_STATE);
+    for (size_t n = 0; n < codes_num; n++) {
+        RF_CHECK(codes[n].tag != 0, "tag 0 is reserved for unknown codes", ESP_ERR_INVALID_ARG);
+    }
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(s_codes_lock, portMAX_DELAY);
+    for (size_t n = 0; n < codes_num && err == ESP_OK; n++) {
+        err = code_table_put(s_codes, &codes[n]);
+    }
+    xSemaphoreGive(s_codes_lock);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "known codes table is full");
+    }
+    return err;
+}
+
+esp_err_t rf_codes_remove(uint16_t protocol, uint8_t bits, uint64_t raw_code) {
+    RF_CHECK(s_codes != NULL, "known codes table is not enabled", ESP_ERR_INVALID_STATE);
+
+    xSemaphoreTake(s_codes_lock, portMAX_DELAY);
+    bool removed = code_table_remove(s_codes, protocol, bits, raw_code);
+    xSemaphoreGive(s_codes_lock);
+    return removed ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t rf_codes_clear(void) {
+    RF_CHECK(s_codes != NULL, "known codes table is not enabled", ESP_ERR_INVALID_STATE);
+
+    xSemaphoreTake(s_codes_lock, portMAX_DELAY);
+    code_table_clear(s_codes);
+    xSemaphoreGive(s_codes_lock);
+    return ESP_OK;
+}
+
+static esp_err_t set_receiver_pin(int receiver, gpio_num_t gpio_num) {
     RF_CHECK(GPIO_IS_VALID_GPIO(gpio_num), "GPIO number is not valid", ESP_ERR_INVALID_ARG);
 
-    s_gpio_num = gpio_num;
+    s_gpio_num[receiver] = gpio_num;
 
     gpio_config_t io_conf = {
             .pin_bit_mask = (uint64_t) 0x1 << gpio_num,
@@ -161,8 +388,22 @@ esp_err_t rf_set_pin(gpio_num_t gpio_num) {
     return gpio_config(&io_conf);
 }
 
+esp_err_t rf_set_pin(gpio_num_t gpio_num) {
+    return set_receiver_pin(0, gpio_num);
+}
+
 esp_err_t rf_config(const rf_config_t *config) {
     RF_CHECK(rf_set_pin(config->gpio_num) == ESP_OK, "set GPIO for RF driver failed", ESP_ERR_INVALID_ARG);
+    if (config->diversity_enabled) {
+        RF_CHECK(set_receiver_pin(1, config->diversity_gpio_num) == ESP_OK,
+                 "set diversity GPIO for RF driver failed", ESP_ERR_INVALID_ARG);
+        s_receivers_num = 2;
+        s_diversity_window_us = (int64_t) (config->diversity_window_ms ? config->diversity_window_ms : 200) * 1000;
+        ESP_LOGI(TAG, "Diversity receiver: GPIO %d | Window: %d ms",
+                 config->diversity_gpio_num, (int) (s_diversity_window_us / 1000));
+    } else {
+        s_receivers_num = 1;
+    }
     if (config->events_queue_size != 0) {
         s_events_queue_size = config->events_queue_size;
     }
@@ -173,92 +414,157 @@ esp_err_t rf_config(const rf_config_t *config) {
         s_parser_task_priority = config->parser_task_priority;
     }
     s_events_mask = config->events;
+    s_codes_table_size = config->codes_table_size;
+    s_unknown_codes_sample = config->unknown_codes_sample;
+    s_events_ring_size = config->events_ring_size;
 
     ESP_LOGI(TAG, "Pulses queue: %d | Events queue: %d | Events Mask: 0x%01x",
              config->pulses_queue_size, config->events_queue_size, s_events_mask);
     return ESP_OK;
 }
 
-void add_pulse_parser(const pulse_parser_config_t *config, const char *name) {
-    parser_t *parser = pulse_parser_new(config);
-    if (parser == NULL) {
-        ESP_LOGE(TAG, "%s parser memory allocation error", name);
-    } else {
-        ESP_LOGI(TAG, "%s parser created", name);
-        parsers[parsers_num++] = parser;
+/*
+ * @brief Keep the parsers just created for every receiver, or delete them if any is missing
+ */
+static esp_err_t keep_parsers(const char *name) {
+    for (int r = 0; r < s_receivers_num; r++) {
+        if (parsers[r][parsers_num] == NULL) {
+            ESP_LOGE(TAG, "%s parser memory allocation error", name);
+            for (r = 0; r < s_receivers_num; r++) {
+                if (parsers[r][parsers_num] != NULL) {
+                    parsers[r][parsers_num]->del(parsers[r][parsers_num]);
+                    parsers[r][parsers_num] = NULL;
+                }
+            }
+            return ESP_ERR_NO_MEM;
+        }
     }
+    ESP_LOGI(TAG, "%s parser created", name);
+    parsers_num++;
+    return ESP_OK;
 }
 
-void add_nec_parser() {
-    parser_t *parser = nec_parser_new();
-    if (parser == NULL) {
-        ESP_LOGE(TAG, "NEC parser memory allocation error");
-    } else {
-        ESP_LOGI(TAG, "NEC parser created");
-        parsers[parsers_num++] = parser;
+static esp_err_t add_pulse_parser(const pulse_parser_config_t *config, const char *name) {
+    for (int r = 0; r < s_receivers_num; r++) {
+        parsers[r][parsers_num] = pulse_parser_new(config);
     }
+    return keep_parsers(name);
 }
 
-esp_err_t rf_driver_install(int intr_alloc_flags) {
-    RF_CHECK(s_events_queue == NULL, "driver already installed", ESP_ERR_INVALID_ARG);
+#ifdef RF_PD_PARSER_ENABLED
+static esp_err_t add_pd_parser(const pd_protocol_t *protocols, int protocols_num) {
+    for (int r = 0; r < s_receivers_num; r++) {
+        parsers[r][parsers_num] = pd_parser_new(protocols, protocols_num);
+    }
+    ESP_LOGI(TAG, "Pulse distance protocols: %d", protocols_num);
+    return keep_parsers("Pulse distance");
+}
+#endif
 
-    // create protocol parsers
+/*
+ * @brief Delete parsers and pulses dispatchers of all receivers
+ */
+static void delete_parsers(void) {
+    for (int r = 0; r < s_receivers_num; r++) {
+        dispatch_deinit(&s_dispatch[r]);
+        for (int n = 0; n < parsers_num; n++) {
+            parsers[r][n]->del(parsers[r][n]);
+            parsers[r][n] = NULL;
+        }
+    }
+    parsers_num = 0;
+}
+
+/*
+ * @brief Create parsers of enabled protocols and pulses dispatchers of all receivers
+ */
+static esp_err_t create_parsers(void) {
+    esp_err_t err = ESP_OK;
 #ifdef CONFIG_RF_MODULE_PROTOCOL_EV1527
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x1527, .sync_clk = 32, .bit_clk = 4, .code_bits_len = 24, .inverted = false,
-    }, "EV1527");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_EV1527, "EV1527");
 #endif
-#ifdef CONFIG_RF_MODULE_PROTOCOL_KINGSERRY
-    add_nec_parser();
+#ifdef RF_PD_PARSER_ENABLED
+    if (err == ESP_OK) err = add_pd_parser(s_pd_protocols, sizeof(s_pd_protocols) / sizeof(s_pd_protocols[0]));
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_2
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x0002, .sync_clk = 11, .bit_clk = 3, .code_bits_len = 24, .inverted = false,
-    }, "PROTOCOL 2");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_2, "PROTOCOL 2");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_3
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x0003, .sync_clk = 101, .bit_clk = 15, .code_bits_len = 24, .inverted = false,
-    }, "PROTOCOL 3");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_3, "PROTOCOL 3");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_4
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x0004, .sync_clk = 7, .bit_clk = 4, .code_bits_len = 24, .inverted = false,
-    }, "PROTOCOL 4");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_4, "PROTOCOL 4");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_5
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x0005, .sync_clk = 20, .bit_clk = 3, .code_bits_len = 24, .inverted = false,
-    }, "PROTOCOL 5");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_5, "PROTOCOL 5");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_HT6P20B
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x6B20, .sync_clk = 24, .bit_clk = 3, .code_bits_len = 24, .inverted = true,
-    }, "HT6P20B");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_HT6P20B, "HT6P20B");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_HS2303_PT
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x2303, .sync_clk = 64, .bit_clk = 7, .code_bits_len = 24, .inverted = false,
-    }, "HS2303-PT");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_HS2303_PT, "HS2303-PT");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_1BYONE
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x01B1, .sync_clk = 17, .bit_clk = 4, .code_bits_len = 24, .inverted = true,
-    }, "1ByONE");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_1BYONE, "1ByONE");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_HT12E
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x012e, .sync_clk = 17, .bit_clk = 4, .code_bits_len = 24, .inverted = true,
-    }, "HT12E");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_HT12E, "HT12E");
 #endif
 #ifdef CONFIG_RF_MODULE_PROTOCOL_SM5212
-    add_pulse_parser(&(pulse_parser_config_t) {
-            .id = 0x5212, .sync_clk = 37, .bit_clk = 3, .code_bits_len = 24, .inverted = true,
-    }, "SM5212");
+    if (err == ESP_OK) err = add_pulse_parser(&(pulse_parser_config_t) RF_PROTOCOL_SM5212, "SM5212");
 #endif
-    if (parsers_num == 0) {
+    if (err == ESP_OK && parsers_num == 0) {
         ESP_LOGW(TAG, "no protocols parsers created");
     }
+    for (int r = 0; r < s_receivers_num && err == ESP_OK; r++) {
+        err = dispatch_init(&s_dispatch[r], parsers[r], parsers_num);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "cannot create pulses dispatcher");
+        }
+    }
+    if (err != ESP_OK) {
+        delete_parsers();
+    }
+    return err;
+}
+
+esp_err_t rf_driver_install(int intr_alloc_flags) {
+    RF_CHECK(s_events_queue == NULL, "driver already installed", ESP_ERR_INVALID_ARG);
+
+    // create protocol parsers
+    esp_err_t err = create_parsers();
+    if (err != ESP_OK) {
+        return err;
+    }
+    diversity_init(&s_diversity, s_diversity_window_us);
+
+    // create known codes table
+    if (s_codes_table_size != 0) {
+        s_codes_lock = xSemaphoreCreateMutex();
+        s_codes = code_table_new(s_codes_table_size);
+        code_filter_init(&s_codes_filter, s_unknown_codes_sample);
+        if (s_codes_lock == NULL || s_codes == NULL) {
+            ESP_LOGE(TAG, "cannot create known codes table");
+            goto fail;
+        }
+        ESP_LOGI(TAG, "Known codes table: %d | Unknown codes sample: %d", s_codes_table_size, s_unknown_codes_sample);
+    }
+
+    s_learn_lock = xSemaphoreCreateMutex();
+    if (s_learn_lock == NULL) {
+        ESP_LOGE(TAG, "cannot create learning mode lock");
+        goto fail;
+    }
+
+    // create broadcast events ring
+    if (s_events_ring_size != 0) {
+        s_events_ring = events_ring_new(s_events_ring_size);
+        if (s_events_ring == NULL) {
+            ESP_LOGE(TAG, "cannot create events ring");
+            goto fail;
+        }
+        ESP_LOGI(TAG, "Events ring: %d", s_events_ring_size);
+    }
 
     // create events queue
     s_events_queue = xQueueCreate(s_events_queue_size, sizeof(rf_event_t));
@@ -275,6 +581,23 @@ esp_err_t rf_driver_install(int intr_alloc_flags) {
 
     // setup GPIO interrupt
     ESP_ERROR_CHECK(gpio_install_isr_service(intr_alloc_flags));
-    ESP_ERROR_CHECK(gpio_isr_handler_add(s_gpio_num, rf_isr_handler, NULL));
+    for (int r = 0; r < s_receivers_num; r++) {
+        ESP_ERROR_CHECK(gpio_isr_handler_add(s_gpio_num[r], rf_isr_handler, (void *) (intptr_t) r));
+    }
     return ESP_OK;
+
+fail:
+    // nothing is left behind, so the install can be tried again
+    if (s_learn_lock != NULL) {
+        vSemaphoreDelete(s_learn_lock);
+        s_learn_lock = NULL;
+    }
+    if (s_codes_lock != NULL) {
+        vSemaphoreDelete(s_codes_lock);
+        s_codes_lock = NULL;
+    }
+    code_table_free(s_codes);
+    s_codes = NULL;
+    delete_parsers();
+    return ESP_ERR_NO_MEM;
 }
@@ -0,0 +1,128 @@
+#include "rf433_events.h"
+#include "rf433_utils.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+
+static const char *TAG = "rf_events";
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+events_ring_t *events_ring_new(size_t size) {
+    RF_CHECK(size > 0 && size <= (1U << 31), "ring size is not valid", NULL);
+
+    // power of 2 size keeps the index continuous when sequence numbers wrap around
+    uint32_t slots = 1;
+    while (slots < size) {
+        slots <<= 1;
+    }
+
+    events_ring_t *ring = calloc(1, sizeof(events_ring_t));
+    RF_CHECK(ring, "cannot allocate memory for events_ring_t", NULL);
+
+    ring->events = malloc(slots * sizeof(rf_event_t));
+    ring->lock = xSemaphoreCreateMutex();
+    if (ring->events == NULL || ring->lock == NULL) {
+        ESP_LOGE(TAG, "cannot allocate memory for %" PRIu32 " events", slots);
+        if (ring->lock != NULL) {
+            vSemaphoreDelete(ring->lock);
+        }
+        free(ring->events);
+        free(ring);
+        return NULL;
+    }
+    ring->size = slots;
+    return ring;
+}
+
+void IRAM_ATTR events_ring_write(events_ring_t *ring, const rf_event_t *event) {
+    xSemaphoreTake(ring->lock, portMAX_DELAY);
+    ring->events[ring->head & (ring->size - 1)] = *event;
+    ring->head++;
+    for (struct rf_events_reader_s *reader = ring->readers; reader != NULL; reader = reader->next) {
+        xSemaphoreGive(reader->ready);
+    }
+    xSemaphoreGive(ring->lock);
+}
+
+rf_events_reader_handle_t events_ring_reader_new(events_ring_t *ring) {
+    struct rf_events_reader_s *reader = malloc(sizeof(struct rf_events_reader_s));
+    RF_CHECK(reader, "cannot allocate memory for events reader", NULL);
+
+    reader->ready = xSemaphoreCreateBinary();
+    if (reader->ready == NULL) {
+        ESP_LOGE(TAG, "cannot create events reader semaphore");
+        free(reader);
+        return NULL;
+    }
+    reader->ring = ring;
+
+    xSemaphoreTake(ring->lock, portMAX_DELAY);
+    reader->cursor = ring->head;
+    reader->next = ring->readers;
+    ring->readers = reader;
+    xSemaphoreGive(ring->lock);
+    return reader;
+}
+
+void events_ring_reader_delete(rf_events_reader_handle_t reader) {
+    events_ring_t *ring = reader->ring;
+
+    xSemaphoreTake(ring->lock, portMAX_DELAY);
+    for (struct rf_events_reader_s **r = &ring->readers; *r != NULL; r = &(*r)->next) {
+        if (*r == reader) {
+            *r = reader->next;
+            break;
+        }
+    }
+    xSemaphoreGive(ring->lock);
+
+    vSemaphoreDelete(reader->ready);
+    free(reader);
+}
+
+esp_err_t events_ring_read(rf_events_reader_handle_t reader, rf_event_t *event, uint32_t *missed,
+                           TickType_t ticks_to_wait) {
+    events_ring_t *ring = reader->ring;
+    TimeOut_t timeout;
+    vTaskSetTimeOutState(&timeout);
+
+    for (;;) {
+        xSemaphoreTake(ring->lock, portMAX_DELAY);
+        uint32_t lag = ring->head - reader->cursor;
+        if (lag != 0) {
+            uint32_t lost = 0;
+            if (lag > ring->size) {  // the writer has overwritten events the reader didn't get
+                lost = lag - ring->size;
+                reader->cursor += lost;
+            }
+            *event = ring->events[reader->cursor & (ring->size - 1)];
+            reader->cursor++;
+            xSemaphoreGive(ring->lock);
+            if (missed != NULL) {
+                *missed = lost;
+            }
+            return ESP_OK;
+        }
+        xSemaphoreGive(ring->lock);
+
+        // the semaphore may be given for events already read, so check the ring again after wake up
+        if (xTaskCheckForTimeOut(&timeout, &ticks_to_wait) == pdTRUE ||
+            xSemaphoreTake(reader->ready, ticks_to_wait) == pdFALSE) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
+
+uint32_t events_ring_lag(rf_events_reader_handle_t reader) {
+    events_ring_t *ring = reader->ring;
+
+    xSemaphoreTake(ring->lock, portMAX_DELAY);
+    uint32_t lag = ring->head - reader->cursor;
+    xSemaphoreGive(ring->lock);
+    return lag;
+}
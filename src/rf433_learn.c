@@ -0,0 +1,382 @@
+#include "rf433_learn.h"
+#include "rf433_utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+
+static const char *TAG = "rf_learn";
+
+#define LEARN_CLUSTERS_MAX     32
+#define LEARN_CLUSTER_SPREAD   130  // widths up to 130% of the shortest width in cluster belong to the cluster
+#define LEARN_SYNC_RATIO_MIN   4    // SYNC pulse is at least 4 times longer than the shortest pulse
+#define LEARN_FRAMES_MAX       64
+#define LEARN_SPREAD_MAX       (2 * PULSE_SOFT_BIT_TOLERANCE)  // widths of the same symbol fit the soft bit window
+#define LEARN_RANGE_MARGIN     10   // pulse distance ranges are widened by 10% of the mean
+#define LEARN_SYNC_SPREAD      10   // max deviation (percent of median) of SYNC widths taken into account
+
+typedef struct {
+    int min;
+    int max;
+    int count;
+    int64_t sum;
+} stats_t;
+
+typedef struct {
+    size_t start;          // index of the SYNC pulse before the frame
+    size_t end;            // index of the SYNC pulse after the frame
+} frame_t;
+
+typedef struct {
+    stats_t clusters[LEARN_CLUSTERS_MAX];
+    frame_t found[LEARN_FRAMES_MAX];   // all frames
+    frame_t frames[LEARN_FRAMES_MAX];  // frames of the most common length
+    uint64_t codes[LEARN_FRAMES_MAX];  // codes of the frames
+    int values[LEARN_FRAMES_MAX];      // SYNC widths
+} learn_work_t;
+
+/**********************************************************************************
+ * Private Methods
+ **********************************************************************************/
+
+static inline void stats_reset(stats_t *s) {
+    s->min = INT32_MAX;
+    s->max = 0;
+    s->count = 0;
+    s->sum = 0;
+}
+
+static inline void stats_add(stats_t *s, int value) {
+    if (value < s->min) s->min = value;
+    if (value > s->max) s->max = value;
+    s->count++;
+    s->sum += value;
+}
+
+static inline int stats_mean(const stats_t *s) {
+    return s->count ? (int) ((s->sum + s->count / 2) / s->count) : 0;
+}
+
+static inline int stats_spread(const stats_t *s) {  // percent of mean
+    int mean = stats_mean(s);
+    return mean ? (s->max - s->min) * 100 / mean : 100;
+}
+
+static inline int stats_deviation(const stats_t *s) {  // max deviation from mean, percent of mean rounded up
+    int mean = stats_mean(s);
+    int diff = (mean - s->min) > (s->max - mean) ? (mean - s->min) : (s->max - mean);
+    return mean ? (diff * 100 + mean - 1) / mean : 100;
+}
+
+static inline void stats_to_range(const stats_t *s, rf_range_t *range) {
+    if (s->count == 0) {
+        range->min = 0;
+        range->max = 0;
+        return;
+    }
+    int margin = divint(stats_mean(s) * LEARN_RANGE_MARGIN, 100);
+    range->min = s->min - margin;
+    range->max = s->max + margin;
+}
+
+static int compare_int(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+/*
+ * @brief Group sorted widths into clusters
+ *
+ * @return
+ *      number of clusters or -1 if out of memory
+ */
+static int find_clusters(const pulse_t *pulses, size_t len, stats_t *clusters, int *widths_num) {
+    int *widths = malloc(len * sizeof(int));
+    RF_CHECK(widths, "cannot allocate memory for widths", -1);
+
+    int num = 0;
+    for (size_t n = 0; n < len; n++) {
+        if (pulses[n].time_us > 0 && pulses[n].time_us < INT32_MAX) {
+            widths[num++] = (int) pulses[n].time_us;
+        }
+    }
+    qsort(widths, num, sizeof(int), compare_int);
+
+    int clusters_num = 0;
+    stats_t *c = NULL;
+    for (int n = 0; n < num; n++) {
+        if (c == NULL || (int64_t) widths[n] * 100 > (int64_t) c->min * LEARN_CLUSTER_SPREAD) {
+            if (clusters_num == LEARN_CLUSTERS_MAX) {
+                break;  // the rest are rare long gaps
+            }
+            c = &clusters[clusters_num++];
+            stats_reset(c);
+        }
+        stats_add(c, widths[n]);
+    }
+    free(widths);
+    *widths_num = num;
+    return clusters_num;
+}
+
+/*
+ * @brief Find frames between SYNC pulses and keep the ones of the most common length
+ *
+ * @return
+ *      number of frames kept
+ */
+static int find_frames(const pulse_t *pulses, size_t len, const stats_t *sync, learn_work_t *work,
+                       size_t *frame_len) {
+    frame_t *found = work->found;
+    frame_t *frames = work->frames;
+    int found_num = 0;
+
+    size_t last_sync = SIZE_MAX;
+    for (size_t n = 0; n < len && found_num < LEARN_FRAMES_MAX; n++) {
+        if (pulses[n].time_us == 0) {  // gap in capture
+            last_sync = SIZE_MAX;
+            continue;
+        }
+        if (pulses[n].time_us < sync->min || pulses[n].time_us > sync->max) {
+            continue;
+        }
+        // the frame is the short part of SYNC and pairs of bit pulses
+        if (last_sync != SIZE_MAX && n - last_sync >= 4 && (n - last_sync) % 2 == 0) {
+            found[found_num++] = (frame_t) {.start = last_sync, .end = n};
+        }
+        last_sync = n;
+    }
+
+    // the most common length
+    int best_num = 0;
+    for (int i = 0; i < found_num; i++) {
+        int num = 0;
+        for (int k = 0; k < found_num; k++) {
+            num += (found[k].end - found[k].start) == (found[i].end - found[i].start);
+        }
+        if (num > best_num) {
+            best_num = num;
+            *frame_len = found[i].end - found[i].start;
+        }
+    }
+    int frames_num = 0;
+    for (int i = 0; i < found_num; i++) {
+        if (found[i].end - found[i].start == *frame_len) {
+            frames[frames_num++] = found[i];
+        }
+    }
+    return frames_num;
+}
+
+/*
+ * @brief Index of the first pulse of the bit in the frame
+ *
+ * Not inverted: SYNC is {short HIGH, long LOW}, so the frame is bits followed by short part of SYNC.
+ * Inverted: SYNC is {long LOW, short HIGH}, so the frame is short part of SYNC followed by bits.
+ */
+static inline size_t bit_index(const frame_t *frame, int bit, bool inverted) {
+    return frame->start + (inverted ? 2 : 1) + 2 * bit;
+}
+
+static inline size_t sync_short_index(const frame_t *frame, bool inverted) {
+    return inverted ? frame->start + 1 : frame->end - 1;
+}
+
+static uint64_t most_common_code(const uint64_t *codes, int num) {
+    uint64_t code = 0;
+    int best_num = 0;
+    for (int i = 0; i < num; i++) {
+        int count = 0;
+        for (int k = 0; k < num; k++) {
+            count += codes[k] == codes[i];
+        }
+        if (count > best_num) {
+            best_num = count;
+            code = codes[i];
+        }
+    }
+    return code;
+}
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+esp_err_t learn_analyze(const pulse_t *pulses, size_t len, rf_learned_protocol_t *protocol) {
+    learn_work_t *work = malloc(sizeof(learn_work_t));
+    RF_CHECK(work, "cannot allocate memory for learn_work_t", ESP_ERR_NO_MEM);
+
+    const stats_t *clusters = work->clusters;
+    int widths_num;
+    int clusters_num = find_clusters(pulses, len, work->clusters, &widths_num);
+    if (clusters_num < 0) {
+        free(work);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // the shortest frequent pulse is the base, rare ones are noise
+    int significant = widths_num / 50 > 2 ? widths_num / 50 : 2;
+    const stats_t *shortest = NULL;
+    for (int n = 0; n < clusters_num && shortest == NULL; n++) {
+        if (clusters[n].count >= significant) {
+            shortest = &clusters[n];
+        }
+    }
+    if (shortest == NULL) {
+        ESP_LOGD(TAG, "no pulses captured");
+        free(work);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // SYNC is the long pulse which splits the capture into frames of the same length covering most pulses
+    const stats_t *sync = NULL;
+    size_t covered = 0;
+    for (int n = 0; n < clusters_num; n++) {
+        const stats_t *c = &clusters[n];
+        if (c->count < 2 || stats_mean(c) < stats_mean(shortest) * LEARN_SYNC_RATIO_MIN) {
+            continue;
+        }
+        size_t c_frame_len = 0;
+        int c_frames_num = find_frames(pulses, len, c, work, &c_frame_len);
+        if (c_frames_num >= 2 && c_frames_num * c_frame_len > covered) {
+            covered = c_frames_num * c_frame_len;
+            sync = c;
+        }
+    }
+    size_t frame_len = 0;
+    int frames_num = sync != NULL ? find_frames(pulses, len, sync, work, &frame_len) : 0;
+    int bits = (int) (frame_len - 2) / 2;
+    if (frames_num < 2 || bits > 64) {
+        ESP_LOGD(TAG, "no repeating frames found");
+        free(work);
+        return ESP_ERR_NOT_FOUND;
+    }
+    const frame_t *frames = work->frames;
+    uint64_t *codes = work->codes;
+
+    // Try both ways to pair pulses: with pulse width encoding only the right one gives the same bit width.
+    stats_t total[2], first[2];
+    for (int inverted = 0; inverted < 2; inverted++) {
+        stats_reset(&total[inverted]);
+        stats_reset(&first[inverted]);
+        for (int f = 0; f < frames_num; f++) {
+            for (int b = 0; b < bits; b++) {
+                size_t i = bit_index(&frames[f], b, inverted);
+                stats_add(&total[inverted], (int) (pulses[i].time_us + pulses[i + 1].time_us));
+                stats_add(&first[inverted], (int) pulses[i].time_us);
+            }
+        }
+    }
+
+    memset(protocol, 0, sizeof(rf_learned_protocol_t));
+    protocol->code_bits_len = bits;
+    protocol->frames = frames_num;
+
+    if (stats_spread(&total[0]) <= LEARN_SPREAD_MAX || stats_spread(&total[1]) <= LEARN_SPREAD_MAX) {
+        bool inverted = stats_spread(&total[1]) < stats_spread(&total[0]);
+        stats_t clock, sync_total;
+        stats_reset(&clock);
+        stats_reset(&sync_total);
+        int *sync_us = work->values;
+        for (int f = 0; f < frames_num; f++) {
+            codes[f] = 0;
+            for (int b = 0; b < bits; b++) {
+                size_t i = bit_index(&frames[f], b, inverted);
+                codes[f] = (codes[f] << 1) | (pulses[i].time_us > pulses[i + 1].time_us);
+            }
+            size_t i = sync_short_index(&frames[f], inverted);
+            sync_us[f] = (int) (pulses[i].time_us + pulses[inverted ? i - 1 : i + 1].time_us);
+        }
+        // the last SYNC of a transmission is often merged with the pause after it, so use the median
+        qsort(sync_us, frames_num, sizeof(int), compare_int);
+        int sync_median = sync_us[frames_num / 2];
+        for (int f = 0; f < frames_num; f++) {
+            size_t i = sync_short_index(&frames[f], inverted);
+            int width = (int) (pulses[i].time_us + pulses[inverted ? i - 1 : i + 1].time_us);
+            if (abs(width - sync_median) * 100 <= sync_median * LEARN_SYNC_SPREAD) {
+                stats_add(&sync_total, width);
+                stats_add(&clock, (int) pulses[i].time_us);
+            }
+        }
+        protocol->encoding = RF_ENCODING_PULSE_WIDTH;
+        protocol->inverted = inverted;
+        // the pulse parser takes the short part of SYNC as the clock tick, bits of some protocols differ from it
+        protocol->clock_us = stats_mean(&clock);
+        protocol->bit_clk = divint(stats_mean(&total[inverted]), protocol->clock_us);
+        protocol->sync_clk = divint(stats_mean(&sync_total), protocol->clock_us);
+        protocol->bit_tolerance = stats_deviation(&total[inverted]);
+        protocol->sync_tolerance = stats_deviation(&sync_total);
+    } else if (stats_spread(&first[0]) <= LEARN_SPREAD_MAX) {
+        // pulse distance: HIGH is fixed, LOW is short for '0' and long for '1'
+        stats_t second, sync_start, sync_width, start_0, start_1, bit_0, bit_1;
+        stats_reset(&second);
+        for (int f = 0; f < frames_num; f++) {
+            for (int b = 0; b < bits; b++) {
+                stats_add(&second, (int) pulses[bit_index(&frames[f], b, false) + 1].time_us);
+            }
+        }
+        int threshold = (second.min + second.max) / 2;
+
+        stats_reset(&sync_start);
+        stats_reset(&sync_width);
+        stats_reset(&start_0);
+        stats_reset(&start_1);
+        stats_reset(&bit_0);
+        stats_reset(&bit_1);
+        for (int f = 0; f < frames_num; f++) {
+            codes[f] = 0;
+            for (int b = 0; b < bits; b++) {
+                size_t i = bit_index(&frames[f], b, false);
+                int bit_width = (int) (pulses[i].time_us + pulses[i + 1].time_us);
+                bool one = pulses[i + 1].time_us > threshold;
+                stats_add(one ? &start_1 : &start_0, (int) pulses[i].time_us);
+                stats_add(one ? &bit_1 : &bit_0, bit_width);
+                codes[f] = (codes[f] << 1) | one;
+            }
+            size_t i = sync_short_index(&frames[f], false);
+            stats_add(&sync_start, (int) pulses[i].time_us);
+            stats_add(&sync_width, (int) (pulses[i].time_us + pulses[i + 1].time_us));
+        }
+        protocol->encoding = RF_ENCODING_PULSE_DISTANCE;
+        stats_to_range(&sync_start, &protocol->sync_start_us);
+        stats_to_range(&sync_width, &protocol->sync_width_us);
+        stats_to_range(&start_0, &protocol->bit_start_0_us);
+        stats_to_range(&start_1, &protocol->bit_start_1_us);
+        stats_to_range(&bit_0, &protocol->bit_width_0_us);
+        stats_to_range(&bit_1, &protocol->bit_width_1_us);
+    } else {
+        ESP_LOGD(TAG, "unknown encoding");
+        free(work);
+        return ESP_ERR_NOT_FOUND;
+    }
+    protocol->raw_code = most_common_code(codes, frames_num);
+    free(work);
+    return ESP_OK;
+}
+
+void learn_pulse_config(const rf_learned_protocol_t *learned, pulse_parser_config_t *config) {
+    *config = (pulse_parser_config_t) {
+        .sync_clk = learned->sync_clk,
+        .bit_clk = learned->bit_clk,
+        .code_bits_len = learned->code_bits_len,
+        .inverted = learned->inverted,
+    };
+}
+
+static inline pd_range_t pd_range(const rf_range_t *range) {
+    return (pd_range_t) {
+        .min = range->min < 0 ? 0 : range->min,
+        .max = range->max > UINT16_MAX ? UINT16_MAX : range->max,
+    };
+}
+
+void learn_pd_protocol(const rf_learned_protocol_t *learned, pd_protocol_t *protocol) {
+    *protocol = (pd_protocol_t) {
+        .code_bits_len = learned->code_bits_len,
+        .sync_start_us = pd_range(&learned->sync_start_us),
+        .sync_width_us = pd_range(&learned->sync_width_us),
+        .bit_start_0_us = pd_range(&learned->bit_start_0_us),
+        .bit_start_1_us = pd_range(&learned->bit_start_1_us),
+        .bit_width_0_us = pd_range(&learned->bit_width_0_us),
+        .bit_width_1_us = pd_range(&learned->bit_width_1_us),
+    };
+}
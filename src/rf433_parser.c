@@ -17,6 +17,8 @@ static inline void prepare_event(parser_runtime_t *p, uint8_t action, rf_event_t
     event->action = action;
     event->raw_code = p->registered.data;
     event->bits = p->registered.bits;
+    event->tag = 0;
+    event->confidence = 100;
 }
 
 /*
@@ -101,3 +103,20 @@ inline void start_new_code(parser_runtime_t *p) {
     p->captured.bits = 0;
     p->captured.data = 0;
 }
+
+/*
+ * @brief Check the parser is looking for SYNC and no code sequence is in progress
+ */
+inline bool is_idle(const parser_runtime_t *p) {
+    return p->captured.bits == -1 && p->codes_num == 0;
+}
+
+/*
+ * @brief Take the pulse as the first one of the next pair without processing it
+ */
+inline void set_first_pulse(parser_runtime_t *p, const pulse_t *pulse) {
+    if (pulse->level == p->first_pulse.level) {
+        p->first_pulse.time_us = pulse->time_us;
+        p->state = WaitingSecondPulse;
+    }
+}
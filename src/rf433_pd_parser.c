@@ -0,0 +1,372 @@
+#include "rf433_pd_parser.h"
+#include "rf433_parser.h"
+#include "rf433_utils.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/param.h>
+#include <esp_log.h>
+
+static const char *TAG = "rf_pd_parser";
+
+#define PD_EDGES_MAX (PD_PROTOCOLS_MAX * 6 + 1)  // 3 windows per descriptor, 2 edges per window
+
+typedef uint16_t pd_mask_t;
+
+/*
+ * Descriptors which windows contain the width
+ */
+typedef struct {
+    pd_mask_t sync;
+    pd_mask_t bit_0;
+    pd_mask_t bit_1;
+} pd_class_t;
+
+/*
+ * Widths are split into intervals by edges of the windows, all widths of an interval have the same class
+ */
+typedef struct {
+    uint16_t *edges;      // sorted starts of the intervals, edges[0] == 0
+    pd_class_t *classes;  // class of every interval
+    int size;
+} pd_table_t;
+
+typedef struct {
+    uint64_t data;        // bits of the current frame
+    uint64_t registered;  // code of the current sequence
+    int bits;             // number of bits of the current frame
+} pd_state_t;
+
+typedef struct {
+    parser_t parent;
+    parser_runtime_t runtime;  // pairs pulses, the codes are in the states of descriptors
+
+    const pd_protocol_t *protocols;
+    int protocols_num;
+    pd_table_t start;     // by width of HIGH pulse
+    pd_table_t width;     // by width of HIGH + LOW pulses
+    pd_state_t *states;
+    pd_mask_t framing;    // descriptors reading bits of a frame
+    pd_mask_t started;    // descriptors in the middle of a codes sequence
+
+    // several descriptors can emit events on the same pulse pair, input() returns the first one
+    // and next_event() the rest
+    rf_event_t *pending;
+    int pending_size;
+    int pending_head;
+    int pending_num;
+} pd_parser_t;
+
+/**********************************************************************************
+ * Private Methods
+ **********************************************************************************/
+
+static int compare_edges(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+static inline bool is_within_pd_range(int value, const pd_range_t *range) {
+    return value >= range->min && value <= range->max;
+}
+
+/*
+ * @brief Build the table from the windows of the descriptors
+ *
+ * @param windows: 3 windows per descriptor: SYNC, '0', '1'
+ */
+static esp_err_t table_init(pd_table_t *t, const pd_range_t *windows, int protocols_num) {
+    int edges[PD_EDGES_MAX];
+    int edges_num = 0;
+
+    edges[edges_num++] = 0;
+    for (int n = 0; n < protocols_num * 3; n++) {
+        edges[edges_num++] = windows[n].min;
+        if (windows[n].max < UINT16_MAX) {
+            edges[edges_num++] = windows[n].max + 1;
+        }
+    }
+    qsort(edges, edges_num, sizeof(int), compare_edges);
+
+    t->edges = malloc(edges_num * (sizeof(uint16_t) + sizeof(pd_class_t)));
+    RF_CHECK(t->edges, "cannot allocate memory for widths table", ESP_ERR_NO_MEM);
+    t->classes = (pd_class_t *) (t->edges + edges_num);
+
+    t->size = 0;
+    for (int e = 0; e < edges_num; e++) {
+        if (t->size != 0 && t->edges[t->size - 1] == edges[e]) {
+            continue;
+        }
+        pd_class_t *c = &t->classes[t->size];
+        *c = (pd_class_t) {0};
+        for (int n = 0; n < protocols_num; n++) {
+            c->sync |= is_within_pd_range(edges[e], &windows[n * 3 + 0]) ? 1U << n : 0;
+            c->bit_0 |= is_within_pd_range(edges[e], &windows[n * 3 + 1]) ? 1U << n : 0;
+            c->bit_1 |= is_within_pd_range(edges[e], &windows[n * 3 + 2]) ? 1U << n : 0;
+        }
+        t->edges[t->size++] = edges[e];
+    }
+    return ESP_OK;
+}
+
+static inline const pd_class_t *classify(const pd_table_t *t, int width_us) {
+    if (width_us > UINT16_MAX) {
+        width_us = UINT16_MAX;
+    }
+    // the last interval which starts before the width
+    int lo = 0, hi = t->size - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (t->edges[mid] <= width_us) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return &t->classes[lo];
+}
+
+static inline void push_event(pd_parser_t *p, int n, uint8_t action) {
+    if (p->pending_num == p->pending_size) {
+        ESP_LOGW(TAG, "events overflow");
+        return;
+    }
+    rf_event_t *event = &p->pending[(p->pending_head + p->pending_num++) % p->pending_size];
+    event->action = action;
+    event->bits = p->protocols[n].code_bits_len;
+    event->confidence = 100;
+    event->raw_code = p->states[n].registered;
+    event->protocol = p->protocols[n].id;
+    event->tag = 0;
+}
+
+static inline bool pop_event(pd_parser_t *p, rf_event_t *event) {
+    if (p->pending_num == 0) {
+        return false;
+    }
+    *event = p->pending[p->pending_head];
+    p->pending_head = (p->pending_head + 1) % p->pending_size;
+    p->pending_num--;
+    return true;
+}
+
+static inline void start_frame(pd_parser_t *p, int n) {
+    p->states[n].data = 0;
+    p->states[n].bits = 0;
+    p->framing |= 1U << n;
+}
+
+/*
+ * @brief The descriptor stops reading bits and looks for SYNC, the sequence of codes is over
+ */
+static inline void stop(pd_parser_t *p, int n) {
+    if (p->started & (1U << n)) {
+        push_event(p, n, RF_ACTION_STOP);
+    }
+    p->started &= ~(1U << n);
+    p->framing &= ~(1U << n);
+}
+
+/*
+ * @brief The frame is lost, the descriptor looks for SYNC of the next one and the sequence of codes goes on
+ */
+static inline void lose_frame(pd_parser_t *p, int n, int width_us) {
+    if (width_us > p->protocols[n].sync_width_us.max) {
+        stop(p, n);  // a pair longer than SYNC is a pause after the transmission
+    } else {
+        p->framing &= ~(1U << n);
+    }
+}
+
+/*
+ * @brief SYNC of the next frame found, register the code of the current one
+ *
+ * NOTE: We register the code only when we get SYNC of next code. In that case we drop last code
+ *       that doesn't have SYNC after it. That is made intentionally, see pulse parser.
+ */
+static inline void register_frame(pd_parser_t *p, int n) {
+    pd_state_t *s = &p->states[n];
+    if (s->bits != p->protocols[n].code_bits_len) {
+        // some bits are lost, the frame is dropped
+    } else if (!(p->started & (1U << n)) || s->data != s->registered) {  // new code
+        s->registered = s->data;
+        p->started |= 1U << n;
+        push_event(p, n, RF_ACTION_START);
+    } else {
+        push_event(p, n, RF_ACTION_CONTINUE);
+    }
+    start_frame(p, n);
+}
+
+static void reset_all(pd_parser_t *p) {
+    for (pd_mask_t mask = p->framing | p->started; mask != 0; mask &= mask - 1) {
+        stop(p, __builtin_ctz(mask));
+    }
+    reset(&p->runtime, NULL);
+}
+
+static inline void parse_next_tick(pd_parser_t *p) {
+    int first_us = p->runtime.first_pulse.time_us;
+    int second_us = p->runtime.second_pulse.time_us;
+
+    if (first_us == 0 || second_us == 0) {
+        reset_all(p);
+        return;
+    }
+
+    if (p->framing == 0 && p->started == 0 && !is_within_range(first_us, &p->parent.sync.first_us)) {
+        return;  // looking for SYNC only and it can't be SYNC of any descriptor
+    }
+
+    // one classification of the pair for all descriptors
+    int width_us = first_us + second_us;
+    const pd_class_t *start = classify(&p->start, first_us);
+    const pd_class_t *width = classify(&p->width, width_us);
+    pd_mask_t sync = start->sync & width->sync;
+    pd_mask_t bit_0 = start->bit_0 & width->bit_0;
+    pd_mask_t bit_1 = start->bit_1 & width->bit_1;
+
+    pd_mask_t hunting = sync & ~p->framing;
+    for (pd_mask_t mask = p->framing; mask != 0; mask &= mask - 1) {
+        int n = __builtin_ctz(mask);
+        pd_state_t *s = &p->states[n];
+        if ((bit_0 | bit_1) & (1U << n)) {
+            if (s->bits == p->protocols[n].code_bits_len) {  // data overflow
+                lose_frame(p, n, width_us);
+                continue;
+            }
+            s->data = (s->data << 1) | ((bit_1 >> n) & 0x1);
+            s->bits++;
+        } else if (sync & (1U << n)) {
+            register_frame(p, n);
+        } else {  // just a noise
+            lose_frame(p, n, width_us);
+        }
+    }
+    // the descriptors which lost a frame of a sequence look for SYNC of the next one
+    for (pd_mask_t mask = p->started & ~p->framing & ~hunting; mask != 0; mask &= mask - 1) {
+        lose_frame(p, __builtin_ctz(mask), width_us);
+    }
+    for (pd_mask_t mask = hunting; mask != 0; mask &= mask - 1) {
+        start_frame(p, __builtin_ctz(mask));
+    }
+}
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+/*
+ * @brief Consume the next pulse
+ *
+ * @return
+ *     true if the event must be triggered
+ */
+static bool IRAM_ATTR pd_parser_input(parser_t *parser, const pulse_t *pulse, rf_event_t *event) {
+    pd_parser_t *p = __containerof(parser, pd_parser_t, parent);
+
+    switch (next_pulse(&p->runtime, pulse)) {
+        case ParserDoReset:
+            reset_all(p);
+            break;
+        case ParserProcessTick:
+            parse_next_tick(p);
+            break;
+        default:
+            break;
+    }
+    return pop_event(p, event);
+}
+
+static bool IRAM_ATTR pd_parser_next_event(parser_t *parser, rf_event_t *event) {
+    pd_parser_t *p = __containerof(parser, pd_parser_t, parent);
+    return pop_event(p, event);
+}
+
+static bool IRAM_ATTR pd_parser_is_idle(parser_t *parser) {
+    pd_parser_t *p = __containerof(parser, pd_parser_t, parent);
+    return p->framing == 0 && p->started == 0 && p->pending_num == 0;
+}
+
+static void IRAM_ATTR pd_parser_prime(parser_t *parser, const pulse_t *pulse) {
+    pd_parser_t *p = __containerof(parser, pd_parser_t, parent);
+    set_first_pulse(&p->runtime, pulse);
+}
+
+static void pd_parser_del(parser_t *parser) {
+    pd_parser_t *p = __containerof(parser, pd_parser_t, parent);
+    free(p->start.edges);
+    free(p->width.edges);
+    free(p->states);
+    free(p->pending);
+    free(p);
+}
+
+parser_t *pd_parser_new(const pd_protocol_t *protocols, int protocols_num) {
+    RF_CHECK(protocols, "protocols can't be null", NULL);
+    RF_CHECK(protocols_num > 0 && protocols_num <= PD_PROTOCOLS_MAX, "wrong number of protocols", NULL);
+    for (int n = 0; n < protocols_num; n++) {
+        RF_CHECK(protocols[n].code_bits_len > 0 && protocols[n].code_bits_len <= 64, "code length is not valid", NULL);
+    }
+
+    pd_parser_t *parser = calloc(1, sizeof(pd_parser_t));
+    RF_CHECK(parser, "cannot allocate memory for pd_parser_t", NULL);
+
+    parser->parent.input = pd_parser_input;
+    parser->parent.next_event = pd_parser_next_event;
+    parser->parent.is_idle = pd_parser_is_idle;
+    parser->parent.prime = pd_parser_prime;
+    parser->parent.del = pd_parser_del;
+    parser->protocols = protocols;
+    parser->protocols_num = protocols_num;
+
+    pd_range_t start[PD_PROTOCOLS_MAX * 3], width[PD_PROTOCOLS_MAX * 3];
+    sync_band_t *band = &parser->parent.sync;
+    *band = (sync_band_t) {
+            .first_level = 1,
+            .first_us = {.min = INT_MAX, .max = 0},
+            .second_us = {.min = INT_MAX, .max = 0},
+            .ratio = {.min = 0, .max = INT_MAX},
+            .ratio_inverted = false,
+    };
+    for (int n = 0; n < protocols_num; n++) {
+        const pd_protocol_t *pr = &protocols[n];
+        start[n * 3 + 0] = pr->sync_start_us;
+        start[n * 3 + 1] = pr->bit_start_0_us;
+        start[n * 3 + 2] = pr->bit_start_1_us;
+        width[n * 3 + 0] = pr->sync_width_us;
+        width[n * 3 + 1] = pr->bit_width_0_us;
+        width[n * 3 + 2] = pr->bit_width_1_us;
+
+        // any SYNC of the descriptors is within the band
+        int second_min = pr->sync_width_us.min - pr->sync_start_us.max;
+        int second_max = pr->sync_width_us.max - pr->sync_start_us.min;
+        band->first_us.min = MIN(band->first_us.min, pr->sync_start_us.min);
+        band->first_us.max = MAX(band->first_us.max, pr->sync_start_us.max);
+        band->second_us.min = MIN(band->second_us.min, MAX(second_min, 1));
+        band->second_us.max = MAX(band->second_us.max, pr->sync_width_us.max == UINT16_MAX ? INT_MAX : second_max);
+    }
+    if (band->first_us.max == UINT16_MAX) {
+        band->first_us.max = INT_MAX;
+    }
+
+    parser->states = calloc(protocols_num, sizeof(pd_state_t));
+    parser->pending_size = protocols_num * 2;
+    parser->pending = calloc(parser->pending_size, sizeof(rf_event_t));
+    if (parser->states == NULL || parser->pending == NULL ||
+        table_init(&parser->start, start, protocols_num) != ESP_OK ||
+        table_init(&parser->width, width, protocols_num) != ESP_OK) {
+        ESP_LOGE(TAG, "cannot allocate memory for pd_parser_t");
+        free(parser->start.edges);
+        free(parser->states);
+        free(parser->pending);
+        free(parser);
+        return NULL;
+    }
+
+    init(&parser->runtime, (parser_runtime_config_t){
+            .protocol_id = protocols[0].id,
+            .code_bits_len = protocols[0].code_bits_len,
+            .inverted = false,
+    });
+    return &parser->parent;
+}
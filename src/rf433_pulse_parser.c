@@ -2,10 +2,28 @@
 #include "rf433_parser.h"
 #include "rf433_utils.h"
 
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 #include <esp_log.h>
 
 static const char *TAG = "rf_pulse_parser";
 
+#define BIT_CONF_MAX        15  // confidence of a bit with ideal widths ratio
+#define BIT_CONF_HARD       8   // min confidence of a bit within the bit width window
+#define FRAME_BAD_PAIRS_MAX 4   // a frame with more pulse pairs that are not bits is lost
+#define VOTE_MIN            24  // min sum of confidences to decide a bit by majority vote
+#define VOTE_FRAMES_MAX     16  // votes are halved to forget old frames
+#define VOTE_WINDOW_FRAMES  4   // votes are dropped after that many frames without a voted one
+
+/*
+ * Votes for a bit over repeated frames
+ */
+typedef struct {
+    int16_t sum;          // sum of signed confidences, positive for '1'
+    uint16_t weight;      // sum of confidences
+} bit_vote_t;
+
 typedef struct {
     parser_t parent;
     parser_runtime_t runtime;
@@ -13,8 +31,26 @@ typedef struct {
     pulse_parser_config_t config;
 
     range_t sync_us;      // sync tick length
+    range_t soft_sync_us; // sync tick length of the next code drifted out of sync_us
     range_t sync_ratio;   // second pulse width / first pulse width
     range_t bit_us;       // bit tick length
+    range_t soft_bit_us;  // bit tick length for bits with low confidence
+    int frame_us;         // expected frame length with SYNC
+
+    // current frame, the bits before the first glitch are aligned to the SYNC before the frame,
+    // the bits after the latest glitch are aligned to the SYNC after the frame
+    int8_t *frame;        // signed confidences of bits before the first glitch
+    int8_t *suffix;       // ring of signed confidences of bits after the latest glitch
+    int prefix_len;       // number of bits before the first glitch, -1 if there are no glitches
+    int suffix_len;
+    int suffix_head;
+    int bad_pairs;        // number of pulse pairs that are neither bits nor SYNC
+    bool frame_soft;      // the frame has bits out of the bit width window
+
+    // majority vote over repeated frames
+    bit_vote_t *votes;
+    int votes_frames;
+    int64_t votes_age_us; // time since the latest voted frame
 } pulse_parser_t;
 
 /**********************************************************************************
@@ -27,6 +63,211 @@ static inline bool is_sync_ratio(pulse_parser_t *p, int first, int second) {
        is_within_range(divint(second, first), &p->sync_ratio);
 }
 
+static inline void new_frame(pulse_parser_t *p) {
+    start_new_code(&p->runtime);
+    p->prefix_len = -1;
+    p->suffix_len = 0;
+    p->suffix_head = 0;
+    p->bad_pairs = 0;
+    p->frame_soft = false;
+}
+
+static inline void clear_votes(pulse_parser_t *p) {
+    memset(p->votes, 0, p->config.code_bits_len * sizeof(bit_vote_t));
+    p->votes_frames = 0;
+    p->votes_age_us = 0;
+}
+
+static inline void look_for_sync(pulse_parser_t *p, int first_us, int second_us) {
+    if (!is_sync_ratio(p, first_us, second_us)) return;
+
+    // sync pulse found
+    int sync_width = first_us + second_us;
+    // does it look like previous SYNC?
+    if (is_within_range(sync_width, &p->sync_us)) {
+        // just use already calculated values to save some CPU time
+    } else {
+        int base_pulse_width = divint(sync_width, p->config.sync_clk);
+        int base_bit_width = base_pulse_width * p->config.bit_clk;
+        make_range(&p->bit_us, base_bit_width, PULSE_BIT_TOLERANCE);
+        make_range(&p->soft_bit_us, base_bit_width, PULSE_SOFT_BIT_TOLERANCE);
+        make_range(&p->sync_us, sync_width, 1);
+        make_range(&p->soft_sync_us, sync_width, 25);
+        p->frame_us = sync_width + base_bit_width * p->config.code_bits_len;
+    }
+    // start reading data bits
+    new_frame(p);
+}
+
+/*
+ * @brief Get confidence of a bit from the widths ratio of its pulses, it is a weight of the bit in votes
+ *
+ * @return
+ *      BIT_CONF_MAX if one pulse is at least 1.5 times as long as the other one (Protocol 3 sends {9, 6}),
+ *      0 for equal pulses
+ */
+static inline int bit_confidence(int first_us, int second_us) {
+    int conf = BIT_CONF_MAX * 5 * abs(first_us - second_us) / (first_us + second_us);
+    return conf < BIT_CONF_MAX ? conf : BIT_CONF_MAX;
+}
+
+/*
+ * @brief Pulse pair is neither a bit nor SYNC
+ *
+ * @return
+ *      false if the frame is lost
+ */
+static inline bool glitch(pulse_parser_t *p) {
+    if (++p->bad_pairs > FRAME_BAD_PAIRS_MAX) {
+        return false;
+    }
+    if (p->prefix_len < 0) {
+        p->prefix_len = p->runtime.captured.bits;
+    }
+    // position of the bits between glitches is unknown
+    p->suffix_len = 0;
+    p->suffix_head = 0;
+    return true;
+}
+
+/*
+ * @brief Store the next bit of the current frame
+ *
+ * @return
+ *      false if the frame is lost
+ */
+static inline bool push_bit(pulse_parser_t *p, bool bit, int conf) {
+    int len = p->config.code_bits_len;
+    int8_t value = bit ? conf : -conf;
+
+    p->runtime.captured.bits++;  // potentially, we can capture more bits than needed due to noise (e.g. sync missed)
+    if (p->prefix_len < 0) {
+        if (p->runtime.captured.bits <= len) {
+            p->frame[p->runtime.captured.bits - 1] = value;
+            p->runtime.captured.data = (p->runtime.captured.data << 1) | bit;
+            return true;
+        }
+        // data overflow, SYNC is broken into bits. The next bits are aligned to the SYNC after them.
+        if (!glitch(p)) {
+            return false;
+        }
+    }
+    // after a glitch keep the latest bits only, they are aligned to the end of the frame
+    if (p->suffix_len == len) {
+        p->suffix_head = (p->suffix_head + 1) % len;
+    } else {
+        p->suffix_len++;
+    }
+    p->suffix[(p->suffix_head + p->suffix_len - 1) % len] = value;
+    if (p->prefix_len + p->suffix_len > len) {
+        p->prefix_len = 0;  // the bits before the glitch are from the previous frame
+    }
+    return true;
+}
+
+/*
+ * @brief Add the current frame to votes
+ *
+ * @return
+ *      false if the frame has too few bits to be voted
+ */
+static bool vote_frame(pulse_parser_t *p) {
+    int len = p->config.code_bits_len;
+    int prefix_len = p->prefix_len < 0 ? p->runtime.captured.bits : p->prefix_len;
+    int suffix_len = p->prefix_len < 0 ? 0 : p->suffix_len;
+
+    if (p->prefix_len < 0 && prefix_len != len) {
+        return false;  // bits are lost without a glitch, they can't be aligned
+    }
+    if ((prefix_len + suffix_len) * 4 < len * 3) {
+        return false;
+    }
+    // a confident bit against decided one means another code, the votes are kept only if they agree with the frame
+    for (int n = 0; n < prefix_len + suffix_len; n++) {
+        int pos = n < prefix_len ? n : len - suffix_len + (n - prefix_len);
+        int8_t value = n < prefix_len ? p->frame[n] : p->suffix[(p->suffix_head + n - prefix_len) % len];
+        if (abs(value) >= BIT_CONF_HARD && abs(p->votes[pos].sum) >= VOTE_MIN && (p->votes[pos].sum > 0) != (value > 0)) {
+            clear_votes(p);
+            break;
+        }
+    }
+    if (p->votes_frames == VOTE_FRAMES_MAX) {
+        for (int n = 0; n < len; n++) {
+            p->votes[n].sum /= 2;
+            p->votes[n].weight /= 2;
+        }
+        p->votes_frames /= 2;
+    }
+    for (int n = 0; n < prefix_len; n++) {
+        p->votes[n].sum += p->frame[n];
+        p->votes[n].weight += abs(p->frame[n]);
+    }
+    for (int n = 0; n < suffix_len; n++) {
+        int8_t value = p->suffix[(p->suffix_head + n) % len];
+        p->votes[len - suffix_len + n].sum += value;
+        p->votes[len - suffix_len + n].weight += abs(value);
+    }
+    p->votes_frames++;
+    p->votes_age_us = 0;
+    return true;
+}
+
+/*
+ * @brief Reconstruct the code by majority vote
+ *
+ * @return
+ *      confidence of the code in percents, 0 if votes are not strong enough
+ */
+static int decide_code(pulse_parser_t *p, code_t *code) {
+    if (p->votes_frames < 2) {
+        return 0;
+    }
+    int confidence = 99;  // 100 is for codes decoded from a single frame
+    code->data = 0;
+    code->bits = p->config.code_bits_len;
+    for (int n = 0; n < p->config.code_bits_len; n++) {
+        int sum = abs(p->votes[n].sum);
+        // the bit must have enough votes and at least 3/4 of them must agree
+        if (sum < VOTE_MIN || sum * 2 < p->votes[n].weight) {
+            return 0;
+        }
+        code->data = (code->data << 1) | (p->votes[n].sum > 0);
+        int bit_confidence = sum * 100 / (p->votes_frames * BIT_CONF_MAX);
+        if (bit_confidence < confidence) {
+            confidence = bit_confidence;
+        }
+    }
+    return confidence > 0 ? confidence : 1;
+}
+
+/*
+ * @brief SYNC after the current frame is found
+ *
+ * @return
+ *      true if event emitted
+ */
+static bool end_frame(pulse_parser_t *p, rf_event_t *event) {
+    if (p->prefix_len < 0 && !p->frame_soft && p->runtime.captured.bits == p->config.code_bits_len) {
+        // all bits are good
+        vote_frame(p);
+        /*
+         * NOTE: We register the code only when we get SYNC pulse of next code. In that case we drop last code
+         *       that doesn't have SYNC after it. That is made intentionally. Some devices send zeros as last
+         *       bits in last code of the sequence.
+         */
+        return register_code(&p->runtime, event);
+    }
+    if (!vote_frame(p)) {
+        return false;
+    }
+    int confidence = decide_code(p, &p->runtime.captured);
+    if (confidence == 0 || !register_code(&p->runtime, event)) {
+        return false;
+    }
+    event->confidence = confidence;
+    return true;
+}
+
 static inline bool parse_next_tick(pulse_parser_t *p,  rf_event_t *event) {
     int first_us = p->runtime.first_pulse.time_us;
     int second_us = p->runtime.second_pulse.time_us;
@@ -36,51 +277,45 @@ static inline bool parse_next_tick(pulse_parser_t *p,  rf_event_t *event) {
     }
 
     if (p->runtime.captured.bits == -1) { // <-- looking for SYNC
-        if (!is_sync_ratio(p, first_us, second_us)) return false;
-
-        // sync pulse found
-        int sync_width = first_us + second_us;
-        // does it look like previous SYNC?
-        if (is_within_range(sync_width, &p->sync_us)) {
-            // just use already calculated values to save some CPU time
-        } else {
-            int base_pulse_width = divint(sync_width, p->config.sync_clk);
-            int base_bit_width = base_pulse_width * p->config.bit_clk;
-            make_range(&p->bit_us, base_bit_width, 4);
-            make_range(&p->sync_us, sync_width, 1);
-        }
-        // start reading data bits
-        start_new_code(&p->runtime);
+        look_for_sync(p, first_us, second_us);
         return false;
     }
 
     // check next bit tick (high + low pulses) is within base bit tick width (+- 4%)
     int bit_width = first_us + second_us;
-    if (is_within_range(bit_width, &p->bit_us)) {
-        // looks like a bit
-    } else if (is_within_range(bit_width, &p->sync_us) && is_sync_ratio(p, first_us, second_us)) { // width is SYNC and ratio is SYNC
+    if (is_within_range(bit_width, &p->soft_bit_us)) {
+        // looks like a bit, the longer pulse decides it and the widths ratio only weighs it for voting,
+        // transmitters don't have to send ideal bits (e.g. {4, 11} and {9, 6} of Protocol 3)
+        int conf = bit_confidence(first_us, second_us);
+        if (is_within_range(bit_width, &p->bit_us) && first_us != second_us) {
+            conf = conf > BIT_CONF_HARD ? conf : BIT_CONF_HARD;
+        } else {
+            p->frame_soft = true;
+        }
+        if (!push_bit(p, first_us > second_us, conf)) {  // data overflow
+            return reset(&p->runtime, event);
+        }
+        return false;
+    }
+    if (is_within_range(bit_width, &p->sync_us) && is_sync_ratio(p, first_us, second_us)) { // width is SYNC and ratio is SYNC
         // found SYNC of next code
-        /*
-         * NOTE: We register the code only when we get SYNC pulse of next code. In that case we drop last code
-         *       that doesn't have SYNC after it. That is made intentionally. Some devices send zeros as last
-         *       bits in last code of the sequence.
-         */
-        bool event_emitted = register_code(&p->runtime, event);
-        start_new_code(&p->runtime);
+        bool event_emitted = end_frame(p, event);
+        new_frame(p);
         return event_emitted;
-    } else { // just a noise
-        return reset(&p->runtime, event);
     }
-
-    // write bit
-    p->runtime.captured.data <<= 1;
-    // TODO: check pulse's widths ratio. Now just use fast but good workaround.
-    if (first_us > second_us) {
-        p->runtime.captured.data |= 0x1;
+    if (is_within_range(bit_width, &p->soft_sync_us) && is_sync_ratio(p, first_us, second_us)) {
+        // The pair may be SYNC of the next code drifted out of the width of previous SYNC.
+        // Check it right away, otherwise the next code is lost too.
+        bool event_emitted = end_frame(p, event);
+        look_for_sync(p, first_us, second_us);
+        return event_emitted;
     }
-    p->runtime.captured.bits++;  // potentially, we can capture more bits than needed due to noise (e.g. sync missed)
-    if (p->runtime.captured.bits > p->config.code_bits_len) {  // data overflow
-        return reset(&p->runtime, event);
+    // just a noise, keep the rest of the frame for voting. Noise splits pulses, so a pair longer than SYNC
+    // means a pause after the transmission.
+    if (bit_width > p->sync_us.max || !glitch(p)) {
+        bool event_emitted = reset(&p->runtime, event);
+        look_for_sync(p, first_us, second_us);
+        return event_emitted;
     }
     return false;
 }
@@ -92,26 +327,86 @@ static inline bool parse_next_tick(pulse_parser_t *p,  rf_event_t *event) {
 static bool IRAM_ATTR pulse_parser_input(parser_t *parser, const pulse_t *pulse, rf_event_t *event) {
     pulse_parser_t *p = __containerof(parser, pulse_parser_t, parent);
 
+    if (p->votes_frames != 0) {
+        // a pause longer than a frame ends the transmission
+        p->votes_age_us += pulse->time_us;
+        if (pulse->time_us > p->frame_us || p->votes_age_us > (int64_t) p->frame_us * VOTE_WINDOW_FRAMES) {
+            clear_votes(p);
+        }
+    }
+
     switch (next_pulse(&p->runtime, pulse)) {
         case ParserProcessTick:
             return parse_next_tick(p, event);
         case ParserDoReset:
+            if (pulse->time_us == 0) {
+                // pulses are lost (full queue or missed interrupt), whatever was collected is stale
+                clear_votes(p);
+            }
             return reset(&p->runtime, event);
         default:
             return false;
     }
 }
 
+static bool IRAM_ATTR pulse_parser_next_event(parser_t *parser, rf_event_t *event) {
+    return false;  // one event per pulse at most
+}
+
+static bool IRAM_ATTR pulse_parser_is_idle(parser_t *parser) {
+    pulse_parser_t *p = __containerof(parser, pulse_parser_t, parent);
+    return is_idle(&p->runtime) && p->votes_frames == 0;
+}
+
+static void IRAM_ATTR pulse_parser_prime(parser_t *parser, const pulse_t *pulse) {
+    pulse_parser_t *p = __containerof(parser, pulse_parser_t, parent);
+    set_first_pulse(&p->runtime, pulse);
+}
+
+static void pulse_parser_del(parser_t *parser) {
+    pulse_parser_t *p = __containerof(parser, pulse_parser_t, parent);
+    free(p->votes);
+    free(p);
+}
+
 parser_t *pulse_parser_new(const pulse_parser_config_t *config) {
     RF_CHECK(config, "configuration can't be null", NULL);
 
-    pulse_parser_t *parser = malloc(sizeof(pulse_parser_t));
+    RF_CHECK(config->code_bits_len > 0 && config->code_bits_len <= 64, "code length is not valid", NULL);
+
+    pulse_parser_t *parser = calloc(1, sizeof(pulse_parser_t));  // no SYNC width is known yet
     RF_CHECK(parser, "cannot allocate memory for pulse_parser_t", NULL);
 
+    int len = config->code_bits_len;
+    parser->votes = calloc(len, sizeof(bit_vote_t) + 2 * sizeof(int8_t));
+    if (parser->votes == NULL) {
+        free(parser);
+        ESP_LOGE(TAG, "cannot allocate memory for votes");
+        return NULL;
+    }
+    parser->frame = (int8_t *) (parser->votes + len);
+    parser->suffix = parser->frame + len;
+    parser->votes_frames = 0;
+    parser->votes_age_us = 0;
+    parser->frame_us = 0;
+
     parser->parent.input = pulse_parser_input;
+    parser->parent.next_event = pulse_parser_next_event;
+    parser->parent.is_idle = pulse_parser_is_idle;
+    parser->parent.prime = pulse_parser_prime;
+    parser->parent.del = pulse_parser_del;
     parser->config = *config;
     make_range(&parser->sync_ratio, config->sync_clk, 13); // for ratio 32 actual values can be in range 27..33
 
+    // SYNC is recognized by the ratio only, the width defines the clock
+    parser->parent.sync = (sync_band_t) {
+            .first_level = config->inverted ? 0 : 1,
+            .first_us = {.min = 1, .max = INT_MAX},
+            .second_us = {.min = 1, .max = INT_MAX},
+            .ratio = parser->sync_ratio,
+            .ratio_inverted = config->inverted,
+    };
+
     init(&parser->runtime, (parser_runtime_config_t){
             .protocol_id = parser->config.id,
             .code_bits_len = parser->config.code_bits_len,
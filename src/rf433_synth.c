@@ -0,0 +1,307 @@
+#include "rf433_synth.h"
+#include "rf433_protocols.h"
+#include "rf433_utils.h"
+
+#include <stdlib.h>
+#include <esp_log.h>
+
+static const char *TAG = "rf_synth";
+
+// King-Serry symbols, see docs/king-serry.adoc
+#define NEC_CODE_BITS_LEN  40
+#define NEC_START_HIGH_US  200
+#define NEC_START_LOW_US   595
+#define NEC_BIT_HIGH_US    100
+#define NEC_BIT_0_LOW_US   105
+#define NEC_BIT_1_LOW_US   295
+#define NEC_STOP_HIGH_US   100
+#define NEC_STOP_LOW_US    900
+
+// symbols are of RC Switch, SYNC is {1, sync_clk - 1} where the configuration of the driver doesn't match it
+const synth_protocol_t synth_protocols[SYNTH_PROTOCOLS_NUM] = {
+        {"ev1527", RF_PROTOCOL_EV1527, 350, {1, 31}, {1, 3}, {3, 1}},
+        {"p2", RF_PROTOCOL_2, 650, {1, 10}, {1, 2}, {2, 1}},
+        {"p3", RF_PROTOCOL_3, 100, {1, 100}, {4, 11}, {9, 6}},
+        {"p4", RF_PROTOCOL_4, 380, {1, 6}, {1, 3}, {3, 1}},
+        {"p5", RF_PROTOCOL_5, 500, {1, 19}, {1, 2}, {2, 1}},
+        {"ht6p20b", RF_PROTOCOL_HT6P20B, 450, {23, 1}, {1, 2}, {2, 1}},
+        {"hs2303", RF_PROTOCOL_HS2303_PT, 150, {1, 63}, {1, 6}, {6, 1}},
+        {"1byone", RF_PROTOCOL_1BYONE, 365, {16, 1}, {1, 3}, {3, 1}},
+        {"ht12e", RF_PROTOCOL_HT12E, 270, {16, 1}, {1, 3}, {3, 1}},
+        {"sm5212", RF_PROTOCOL_SM5212, 320, {36, 1}, {1, 2}, {2, 1}},
+        {"kingserry", {.code_bits_len = 0}, 0},  // see synth_nec_code()
+};
+
+/**********************************************************************************
+ * Private Methods
+ **********************************************************************************/
+
+static inline uint32_t next_random(uint32_t *state) {  // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static inline bool happens(uint32_t *state, int permille) {
+    return permille > 0 && (int) (next_random(state) % 1000) < permille;
+}
+
+static esp_err_t append(pulse_train_t *train, const pulse_t *pulse) {
+    if (train->len == train->size) {
+        size_t size = train->size ? train->size * 2 : 64;
+        pulse_t *pulses = realloc(train->pulses, size * sizeof(pulse_t));
+        RF_CHECK(pulses, "cannot allocate memory for pulses", ESP_ERR_NO_MEM);
+        train->pulses = pulses;
+        train->size = size;
+    }
+    train->pulses[train->len++] = *pulse;
+    return ESP_OK;
+}
+
+static inline esp_err_t pair(pulse_train_t *train, int first_level, int first_us, int second_us) {
+    esp_err_t err = synth_pulse(train, first_level, first_us);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return synth_pulse(train, !first_level, second_us);
+}
+
+/*
+ * Walks over a train placed on the time axis.
+ */
+typedef struct {
+    const pulse_train_t *train;
+    size_t n;              // current pulse
+    bool started;
+    int64_t next_us;       // time when the level changes next time
+} cursor_t;
+
+static inline bool cursor_done(const cursor_t *c) {
+    return c->started && c->n >= c->train->len;
+}
+
+static inline int cursor_level(const cursor_t *c) {
+    return (!c->started || cursor_done(c)) ? 0 : c->train->pulses[c->n].level;
+}
+
+static void cursor_skip_resets(cursor_t *c) {
+    while (c->n < c->train->len && c->train->pulses[c->n].time_us == 0) {
+        c->n++;
+    }
+    c->next_us = c->n < c->train->len ? c->next_us + c->train->pulses[c->n].time_us : INT64_MAX;
+}
+
+static void cursor_init(cursor_t *c, const pulse_train_t *train, int64_t start_us) {
+    c->train = train;
+    c->n = 0;
+    c->started = false;
+    c->next_us = start_us;
+    if (train->len == 0) {
+        c->started = true;
+        c->next_us = INT64_MAX;
+    }
+}
+
+static void cursor_advance(cursor_t *c) {
+    if (!c->started) {
+        c->started = true;
+    } else {
+        c->n++;
+    }
+    cursor_skip_resets(c);
+}
+
+/**********************************************************************************
+ * Public Interface
+ **********************************************************************************/
+
+pulse_train_t *synth_train_new(size_t size) {
+    pulse_train_t *train = calloc(1, sizeof(pulse_train_t));
+    RF_CHECK(train, "cannot allocate memory for pulse_train_t", NULL);
+
+    if (size != 0) {
+        train->pulses = malloc(size * sizeof(pulse_t));
+        if (train->pulses == NULL) {
+            ESP_LOGE(TAG, "cannot allocate memory for pulses");
+            free(train);
+            return NULL;
+        }
+        train->size = size;
+    }
+    return train;
+}
+
+void synth_train_free(pulse_train_t *train) {
+    if (train != NULL) {
+        free(train->pulses);
+        free(train);
+    }
+}
+
+void synth_train_clear(pulse_train_t *train) {
+    train->len = 0;
+}
+
+esp_err_t synth_pulse(pulse_train_t *train, int level, int time_us) {
+    if (time_us <= 0) {
+        return ESP_OK;
+    }
+    if (train->len != 0) {
+        pulse_t *last = &train->pulses[train->len - 1];
+        if (last->time_us != 0 && last->level == level) {
+            last->time_us += time_us;
+            return ESP_OK;
+        }
+    }
+    return append(train, &(pulse_t) {.level = level, .time_us = time_us});
+}
+
+esp_err_t synth_reset(pulse_train_t *train) {
+    return append(train, &(pulse_t) {.level = 0, .time_us = 0});
+}
+
+esp_err_t synth_pulse_code(pulse_train_t *train, const synth_protocol_t *protocol, uint64_t code, int repeats) {
+    RF_CHECK(protocol && protocol->config.code_bits_len > 0, "configuration error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(protocol->clock_us > 0, "clock must be positive", ESP_ERR_INVALID_ARG);
+
+    // inverted protocols start with LOW
+    int first_level = protocol->config.inverted ? 0 : 1;
+    int clock_us = protocol->clock_us;
+
+    esp_err_t err = ESP_OK;
+    for (int r = 0; r < repeats && err == ESP_OK; r++) {
+        for (int n = protocol->config.code_bits_len - 1; n >= 0 && err == ESP_OK; n--) {
+            const synth_symbol_t *bit = ((code >> n) & 0x1) ? &protocol->one : &protocol->zero;
+            err = pair(train, first_level, bit->first * clock_us, bit->second * clock_us);
+        }
+        if (err == ESP_OK) {
+            err = pair(train, first_level, protocol->sync.first * clock_us, protocol->sync.second * clock_us);
+        }
+    }
+    return err;
+}
+
+esp_err_t synth_nec_code(pulse_train_t *train, uint64_t code, int repeats) {
+    RF_CHECK(repeats > 0, "nothing to send", ESP_ERR_INVALID_ARG);
+
+    esp_err_t err = ESP_OK;
+    for (int r = 0; r < repeats && err == ESP_OK; r++) {
+        err = pair(train, 1, NEC_START_HIGH_US, NEC_START_LOW_US);
+        for (int n = NEC_CODE_BITS_LEN - 1; n >= 0 && err == ESP_OK; n--) {
+            err = pair(train, 1, NEC_BIT_HIGH_US, ((code >> n) & 0x1) ? NEC_BIT_1_LOW_US : NEC_BIT_0_LOW_US);
+        }
+    }
+    if (err == ESP_OK) {
+        err = pair(train, 1, NEC_STOP_HIGH_US, NEC_STOP_LOW_US);
+    }
+    return err;
+}
+
+static inline int middle(const pd_range_t *range) {
+    return (range->min + range->max) / 2;
+}
+
+/*
+ * @brief Pair of pulses in the middle of the windows of start and width
+ */
+static esp_err_t pd_pair(pulse_train_t *train, const pd_range_t *start, const pd_range_t *width) {
+    int width_us = middle(width);
+    int start_us = start->max < width->min ? middle(start) : width_us / 2;
+    return pair(train, 1, start_us, width_us - start_us);
+}
+
+esp_err_t synth_pd_code(pulse_train_t *train, const pd_protocol_t *protocol, uint64_t code, int repeats) {
+    RF_CHECK(protocol && protocol->code_bits_len > 0, "descriptor error", ESP_ERR_INVALID_ARG);
+    RF_CHECK(repeats > 0, "nothing to send", ESP_ERR_INVALID_ARG);
+
+    esp_err_t err = ESP_OK;
+    for (int r = 0; r < repeats && err == ESP_OK; r++) {
+        err = pd_pair(train, &protocol->sync_start_us, &protocol->sync_width_us);
+        for (int n = protocol->code_bits_len - 1; n >= 0 && err == ESP_OK; n--) {
+            err = ((code >> n) & 0x1) ? pd_pair(train, &protocol->bit_start_1_us, &protocol->bit_width_1_us)
+                                      : pd_pair(train, &protocol->bit_start_0_us, &protocol->bit_width_0_us);
+        }
+    }
+    if (err == ESP_OK) {
+        err = pd_pair(train, &protocol->sync_start_us, &protocol->sync_width_us);
+    }
+    return err;
+}
+
+esp_err_t synth_overlay(pulse_train_t *out, const pulse_train_t *a, const pulse_train_t *b, int64_t offset_us) {
+    cursor_t ca, cb;
+    cursor_init(&ca, a, 0);
+    cursor_init(&cb, b, offset_us);
+
+    int level = -1;
+    int64_t level_start_us = 0;
+    int64_t now_us = 0;
+    while (!cursor_done(&ca) || !cursor_done(&cb)) {
+        now_us = ca.next_us < cb.next_us ? ca.next_us : cb.next_us;
+        if (ca.next_us == now_us) cursor_advance(&ca);
+        if (cb.next_us == now_us) cursor_advance(&cb);
+
+        int now_level = cursor_level(&ca) | cursor_level(&cb);
+        if (level == -1) {
+            level = now_level;
+            level_start_us = now_us;
+        } else if (now_level != level) {
+            esp_err_t err = synth_pulse(out, level, (int) (now_us - level_start_us));
+            if (err != ESP_OK) {
+                return err;
+            }
+            level = now_level;
+            level_start_us = now_us;
+        }
+    }
+    // trailing LOW of the transmission
+    return level == -1 ? ESP_OK : synth_pulse(out, level, (int) (now_us - level_start_us));
+}
+
+esp_err_t synth_impair(pulse_train_t *out, const pulse_train_t *in, const synth_impairments_t *impairments) {
+    RF_CHECK(impairments, "impairments can't be null", ESP_ERR_INVALID_ARG);
+
+    const synth_impairments_t *imp = impairments;
+    uint32_t state = imp->seed ? imp->seed : 1;
+    esp_err_t err = ESP_OK;
+
+    for (size_t n = 0; n < in->len && err == ESP_OK; n++) {
+        const pulse_t *pulse = &in->pulses[n];
+        if (pulse->time_us == 0) {
+            err = synth_reset(out);
+            continue;
+        }
+        // the receiver misses the edge after this pulse: it sees the same level twice and reports a reset
+        if (n + 1 < in->len && happens(&state, imp->drop_edge_permille)) {
+            err = synth_reset(out);
+            n++;
+            continue;
+        }
+
+        int64_t width_us = pulse->time_us + pulse->time_us * imp->skew_ppm / 1000000;
+        width_us += pulse->level ? imp->duty_us : -imp->duty_us;
+        if (imp->jitter_us > 0) {
+            width_us += (int) (next_random(&state) % (2 * imp->jitter_us + 1)) - imp->jitter_us;
+        }
+        if (width_us < 1) {
+            width_us = 1;
+        }
+
+        if (happens(&state, imp->noise_permille) && width_us > imp->noise_us + 2) {
+            int head_us = (int) (width_us - imp->noise_us) / 2;
+            err = synth_pulse(out, pulse->level, head_us);
+            if (err == ESP_OK) {
+                err = synth_pulse(out, !pulse->level, imp->noise_us);
+            }
+            if (err == ESP_OK) {
+                err = synth_pulse(out, pulse->level, (int) width_us - imp->noise_us - head_us);
+            }
+        } else {
+            err = synth_pulse(out, pulse->level, (int) width_us);
+        }
+    }
+    return err;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// all protocols are enabled, so the tests cover every parser
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_RF_MODULE_PROTOCOL_EV1527 1
+#define CONFIG_RF_MODULE_PROTOCOL_2 1
+#define CONFIG_RF_MODULE_PROTOCOL_3 1
+#define CONFIG_RF_MODULE_PROTOCOL_4 1
+#define CONFIG_RF_MODULE_PROTOCOL_5 1
+#define CONFIG_RF_MODULE_PROTOCOL_HT6P20B 1
+#define CONFIG_RF_MODULE_PROTOCOL_HS2303_PT 1
+#define CONFIG_RF_MODULE_PROTOCOL_1BYONE 1
+#define CONFIG_RF_MODULE_PROTOCOL_HT12E 1
+#define CONFIG_RF_MODULE_PROTOCOL_SM5212 1
+#define CONFIG_RF_MODULE_PROTOCOL_KINGSERRY 1
+#define CONFIG_RF_MODULE_BENCHMARK 1
+// not used, timings are not compared on the linux target
+#define CONFIG_RF_MODULE_BENCHMARK_TOLERANCE 100
@@ -0,0 +1,17 @@
+#include "test_utils.h"
+#include "driver/rf_bench.h"
+
+/*
+ Benchmark of the parsers against the baseline: events must match, the host timings are printed only.
+*/
+
+#define RESULTS_MAX 64
+
+int main(void) {
+    rf_bench_result_t results[RESULTS_MAX];
+    size_t results_num = RESULTS_MAX;
+
+    TEST_ASSERT_EQUAL(ESP_OK, rf_bench_run(results, &results_num));
+    TEST_ASSERT(results_num > 0 && results_num < RESULTS_MAX);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+#include "test_utils.h"
+#include "rf433_codes.h"
+#include "rf433_pd_parser.h"
+
+#include <string.h>
+
+/*
+ Table of known codes and the filter of events by it.
+*/
+
+#define TABLE_SIZE 8          // 16 slots
+#define REPEATS    4
+
+// EV1527 timings as a descriptor: bits differ in the HIGH pulse, SYNC goes first
+static const pd_protocol_t s_pd_protocols[] = {
+    RF_PROTOCOL_KINGSERRY,
+    { .id = 0x1528, .code_bits_len = 24,
+      .sync_start_us = {300, 400}, .sync_width_us = {10800, 11600},
+      .bit_start_0_us = {300, 400}, .bit_start_1_us = {1000, 1100},
+      .bit_width_0_us = {1300, 1500}, .bit_width_1_us = {1300, 1500} },
+};
+
+static esp_err_t put(code_table_t *table, uint64_t raw_code, uint32_t tag) {
+    rf_code_t code = {.protocol = 0x1527, .bits = 24, .raw_code = raw_code, .tag = tag};
+    return code_table_put(table, &code);
+}
+
+static bool get(const code_table_t *table, uint64_t raw_code, uint32_t *tag) {
+    return code_table_get(table, 0x1527, 24, raw_code, tag);
+}
+
+/*
+ * @brief Slot the code takes in an empty table
+ */
+static uint32_t home_slot(uint64_t raw_code) {
+    code_table_t *table = code_table_new(TABLE_SIZE);
+    TEST_ASSERT(table != NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, put(table, raw_code, 1));
+    uint32_t slot = 0;
+    while (!table->entries[slot].used) {
+        slot++;
+    }
+    code_table_free(table);
+    return slot;
+}
+
+/*
+ * @brief Codes with the same home slot, they form a collision chain
+ */
+static void find_collisions(uint32_t slot, uint64_t *codes, int codes_num) {
+    uint64_t raw_code = 0;
+    for (int n = 0; n < codes_num; n++) {
+        while (home_slot(++raw_code) != slot) {
+        }
+        codes[n] = raw_code;
+    }
+}
+
+static void test_put_get(void) {
+    code_table_t *table = code_table_new(TABLE_SIZE);
+    uint32_t tag = 0;
+
+    TEST_ASSERT(table != NULL);
+    TEST_ASSERT(!get(table, 0x123456, &tag));
+    TEST_ASSERT_EQUAL(ESP_OK, put(table, 0x123456, 7));
+    TEST_ASSERT(get(table, 0x123456, &tag));
+    TEST_ASSERT_EQUAL(7, tag);
+    TEST_ASSERT(get(table, 0x123456, NULL));
+
+    // same code of another protocol or length is another code
+    TEST_ASSERT(!code_table_get(table, 0x0002, 24, 0x123456, NULL));
+    TEST_ASSERT(!code_table_get(table, 0x1527, 23, 0x123456, NULL));
+
+    // put of a known code updates the tag
+    TEST_ASSERT_EQUAL(ESP_OK, put(table, 0x123456, 9));
+    TEST_ASSERT(get(table, 0x123456, &tag));
+    TEST_ASSERT_EQUAL(9, tag);
+    TEST_ASSERT_EQUAL(1, table->count);
+
+    TEST_ASSERT(code_table_remove(table, 0x1527, 24, 0x123456));
+    TEST_ASSERT(!code_table_remove(table, 0x1527, 24, 0x123456));
+    TEST_ASSERT(!get(table, 0x123456, NULL));
+    TEST_ASSERT_EQUAL(0, table->count);
+
+    code_table_free(table);
+}
+
+/*
+ * Removal of an entry in the middle of a collision chain must keep the later entries reachable,
+ * also when the chain wraps around the end of the table.
+ */
+static void test_remove_in_chain(uint32_t slot) {
+    uint64_t codes[3];
+    find_collisions(slot, codes, 3);
+
+    for (int removed = 0; removed < 3; removed++) {
+        code_table_t *table = code_table_new(TABLE_SIZE);
+        TEST_ASSERT(table != NULL);
+        for (int n = 0; n < 3; n++) {
+            TEST_ASSERT_EQUAL(ESP_OK, put(table, codes[n], n + 1));
+        }
+        TEST_ASSERT(code_table_remove(table, 0x1527, 24, codes[removed]));
+        for (int n = 0; n < 3; n++) {
+            uint32_t tag = 0;
+            TEST_ASSERT_EQUAL(n != removed, get(table, codes[n], &tag));
+            if (n != removed) {
+                TEST_ASSERT_EQUAL(n + 1, tag);
+            }
+        }
+        TEST_ASSERT_EQUAL(2, table->count);
+        code_table_free(table);
+    }
+}
+
+static void test_full_table(void) {
+    code_table_t *table = code_table_new(TABLE_SIZE);
+    TEST_ASSERT(table != NULL);
+
+    for (int n = 0; n < TABLE_SIZE; n++) {
+        TEST_ASSERT_EQUAL(ESP_OK, put(table, 0x1000 + n, n + 1));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, put(table, 0x2000, 1));
+    TEST_ASSERT(!get(table, 0x2000, NULL));
+
+    // known codes are still updated, a removed one frees its place
+    TEST_ASSERT_EQUAL(ESP_OK, put(table, 0x1000, 100));
+    TEST_ASSERT(code_table_remove(table, 0x1527, 24, 0x1001));
+    TEST_ASSERT_EQUAL(ESP_OK, put(table, 0x2000, 1));
+    for (int n = 0; n < TABLE_SIZE; n++) {
+        TEST_ASSERT_EQUAL(n != 1, get(table, 0x1000 + n, NULL));
+    }
+
+    code_table_clear(table);
+    TEST_ASSERT_EQUAL(0, table->count);
+    TEST_ASSERT(!get(table, 0x1000, NULL));
+    code_table_free(table);
+}
+
+static bool pass(code_filter_t *filter, const code_table_t *table, uint16_t protocol, uint8_t action,
+                 uint64_t raw_code, uint32_t *tag) {
+    rf_event_t event = {.action = action, .bits = 24, .raw_code = raw_code, .protocol = protocol};
+    bool passed = code_filter_pass(filter, table, &event);
+    *tag = event.tag;
+    return passed;
+}
+
+/*
+ * @brief Whole sequence of the code, returns true if all events passed, false if none of them
+ */
+static bool pass_sequence(code_filter_t *filter, const code_table_t *table, uint64_t raw_code) {
+    uint32_t tag;
+    bool passed = pass(filter, table, 0x1527, RF_ACTION_START, raw_code, &tag);
+    TEST_ASSERT_EQUAL(passed, pass(filter, table, 0x1527, RF_ACTION_CONTINUE, raw_code, &tag));
+    TEST_ASSERT_EQUAL(passed, pass(filter, table, 0x1527, RF_ACTION_STOP, raw_code, &tag));
+    return passed;
+}
+
+static void test_filter(void) {
+    code_table_t *table = code_table_new(TABLE_SIZE);
+    code_filter_t filter;
+    uint32_t tag;
+
+    TEST_ASSERT(table != NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, put(table, 0xAAAA, 5));
+
+    // known codes pass with the tag, unknown ones are dropped without sampling
+    code_filter_init(&filter, 0);
+    TEST_ASSERT(pass(&filter, table, 0x1527, RF_ACTION_START, 0xAAAA, &tag));
+    TEST_ASSERT_EQUAL(5, tag);
+    TEST_ASSERT(!pass(&filter, table, 0x1527, RF_ACTION_START, 0xBBBB, &tag));
+    TEST_ASSERT_EQUAL(0, tag);
+    for (int n = 0; n < 10; n++) {
+        TEST_ASSERT(!pass_sequence(&filter, table, 0xBBBB));
+        TEST_ASSERT(pass_sequence(&filter, table, 0xAAAA));
+    }
+
+    // every 3rd sequence of unknown codes passes whole, known codes don't count
+    code_filter_init(&filter, 3);
+    for (int n = 0; n < 9; n++) {
+        TEST_ASSERT_EQUAL(n % 3 == 0, pass_sequence(&filter, table, 0xBBBB + n));
+        TEST_ASSERT(pass_sequence(&filter, table, 0xAAAA));
+    }
+
+    // sequences of different protocols interleave, each keeps its own decision
+    code_filter_init(&filter, 2);
+    TEST_ASSERT(pass(&filter, table, 0x1527, RF_ACTION_START, 0xBBBB, &tag));
+    TEST_ASSERT(!pass(&filter, table, 0x0002, RF_ACTION_START, 0xCCCC, &tag));
+    TEST_ASSERT(pass(&filter, table, 0x1527, RF_ACTION_CONTINUE, 0xBBBB, &tag));
+    TEST_ASSERT(!pass(&filter, table, 0x0002, RF_ACTION_CONTINUE, 0xCCCC, &tag));
+    TEST_ASSERT(!pass(&filter, table, 0x0002, RF_ACTION_STOP, 0xCCCC, &tag));
+    TEST_ASSERT(pass(&filter, table, 0x1527, RF_ACTION_STOP, 0xBBBB, &tag));
+
+    // a protocol seen first in the middle of its sequence has no decision, it is dropped
+    TEST_ASSERT(!pass(&filter, table, 0x0003, RF_ACTION_CONTINUE, 0xDDDD, &tag));
+
+    code_table_free(table);
+}
+
+/*
+ * One pulse distance parser with two descriptors. The pulse width transmitter is followed by King-Serry
+ * at once: pulses of King-Serry are shorter than the pulse width SYNC, so its sequence is stopped only by
+ * the pause after both and the sequences interleave. Each one must still pass whole or not at all.
+ */
+static void test_filter_descriptors(void) {
+    parser_t *parser = pd_parser_new(s_pd_protocols, 2);
+    pulse_train_t *train = synth_train_new(0);
+    code_table_t *table = code_table_new(TABLE_SIZE);
+    code_filter_t filter;
+    uint64_t codes[2] = {0x12345678AB, 0x9ABCDE};
+    int events[2][3] = {0}, passed[2][3] = {0};
+    bool interleaved = false;
+
+    TEST_ASSERT(parser != NULL && table != NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, synth_pd_code(train, &s_pd_protocols[1], codes[1], REPEATS));
+    TEST_ASSERT_EQUAL(ESP_OK, synth_pd_code(train, &s_pd_protocols[0], codes[0], REPEATS));
+    TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, 0, 20000));
+
+    code_filter_init(&filter, 2);
+    for (size_t i = 0; i < train->len; i++) {
+        rf_event_t event;
+        // a pair can end frames of both descriptors, the parser keeps the other events pending
+        for (bool got = parser->input(parser, &train->pulses[i], &event); got; got = parser->next_event(parser, &event)) {
+            int p = event.protocol == s_pd_protocols[0].id ? 0 : 1;
+            TEST_ASSERT_EQUAL(s_pd_protocols[p].id, event.protocol);
+            TEST_ASSERT_EQUAL(s_pd_protocols[p].code_bits_len, event.bits);
+            TEST_ASSERT_EQUAL(codes[p], event.raw_code);
+            interleaved |= p == 0 && events[1][RF_ACTION_STOP] == 0;
+            events[p][event.action]++;
+            passed[p][event.action] += code_filter_pass(&filter, table, &event);
+        }
+    }
+    TEST_ASSERT(interleaved);
+    for (int p = 0; p < 2; p++) {
+        TEST_ASSERT_EQUAL(1, events[p][RF_ACTION_START]);
+        TEST_ASSERT_EQUAL(1, events[p][RF_ACTION_STOP]);
+        TEST_ASSERT(events[p][RF_ACTION_CONTINUE] > 0);
+    }
+    // the pulse width sequence is the first unknown one and passes, King-Serry is the second
+    TEST_ASSERT_EQUAL(0, memcmp(events[1], passed[1], sizeof(events[1])));
+    TEST_ASSERT_EQUAL(0, passed[0][RF_ACTION_START] + passed[0][RF_ACTION_CONTINUE] + passed[0][RF_ACTION_STOP]);
+
+    code_table_free(table);
+    synth_train_free(train);
+    parser->del(parser);
+}
+
+int main(void) {
+    test_put_get();
+    test_remove_in_chain(3);
+    test_remove_in_chain(TABLE_SIZE * 2 - 1);  // the last slot, the chain wraps around
+    test_full_table();
+    test_filter();
+    test_filter_descriptors();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "test_utils.h"
+#include "rf433_dispatch.h"
+
+#include <string.h>
+
+/*
+ The dispatcher must not change what the parsers decode: feeding every pulse to every parser and feeding
+ them through the dispatcher give the same events on the same pulses, impaired streams included.
+*/
+
+#define TRIALS  200
+#define REPEATS 6
+#define EVENTS_MAX 4            // events of one parser on one pulse
+
+typedef struct {
+    rf_event_t events[SYNTH_PROTOCOLS_NUM][EVENTS_MAX];
+    int events_num[SYNTH_PROTOCOLS_NUM];
+} pulse_events_t;
+
+static void collect(pulse_events_t *pe, int n, const rf_event_t *event) {
+    TEST_ASSERT(pe->events_num[n] < EVENTS_MAX);
+    pe->events[n][pe->events_num[n]++] = *event;
+}
+
+static void collect_event(int n, rf_event_t *event, void *arg) {
+    collect(arg, n, event);
+}
+
+static uint32_t next_random(uint32_t *seed) {
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static void make_parsers(parser_t **parsers) {
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        parsers[n] = test_parser_new(n);
+    }
+}
+
+/*
+ * @brief All protocols one after another with random pauses, impaired with random settings
+ */
+static void make_stream(pulse_train_t *train, uint32_t *seed) {
+    pulse_train_t *clean = synth_train_new(0);
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        TEST_ASSERT_EQUAL(ESP_OK, test_code(clean, n, test_random_code(n, seed), REPEATS));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(clean, 0, 5000 + next_random(seed) % 20000));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, synth_reset(clean));
+
+    synth_impairments_t impairments = {
+            .skew_ppm = (int) (next_random(seed) % 40001) - 20000,
+            .jitter_us = next_random(seed) % 40,
+            .drop_edge_permille = next_random(seed) % 10,
+            .noise_permille = next_random(seed) % 20,
+            .noise_us = 10 + next_random(seed) % 60,
+            .seed = next_random(seed),
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, synth_impair(train, clean, &impairments));
+    synth_train_free(clean);
+}
+
+static void test_equivalence(uint32_t trial) {
+    parser_t *direct[SYNTH_PROTOCOLS_NUM];
+    parser_t *dispatched[SYNTH_PROTOCOLS_NUM];
+    dispatch_t dispatch;
+    make_parsers(direct);
+    make_parsers(dispatched);
+    TEST_ASSERT_EQUAL(ESP_OK, dispatch_init(&dispatch, dispatched, SYNTH_PROTOCOLS_NUM));
+
+    pulse_train_t *train = synth_train_new(0);
+    uint32_t seed = trial + 1;
+    make_stream(train, &seed);
+
+    int events = 0;
+    for (size_t i = 0; i < train->len; i++) {
+        const pulse_t *pulse = &train->pulses[i];
+        pulse_events_t expected = {0}, actual = {0};
+        rf_event_t event;
+
+        for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+            for (bool emitted = direct[n]->input(direct[n], pulse, &event); emitted;
+                 emitted = direct[n]->next_event(direct[n], &event)) {
+                collect(&expected, n, &event);
+            }
+        }
+        dispatch_pulse(&dispatch, pulse, collect_event, &actual);
+        for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+            TEST_ASSERT_EQUAL(expected.events_num[n], actual.events_num[n]);
+            for (int k = 0; k < expected.events_num[n]; k++) {
+                const rf_event_t *e = &expected.events[n][k], *a = &actual.events[n][k];
+                if (e->action != a->action || e->raw_code != a->raw_code) {
+                    printf("trial %u, %s, pulse %zu: expected %d/%llx, got %d/%llx\n",
+                           trial, synth_protocols[n].name, i, e->action, (unsigned long long) e->raw_code,
+                           a->action, (unsigned long long) a->raw_code);
+                    TEST_ASSERT(false);
+                }
+            }
+            events += expected.events_num[n];
+        }
+    }
+    TEST_ASSERT(events > 0);
+    dispatch_deinit(&dispatch);
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        direct[n]->del(direct[n]);
+        dispatched[n]->del(dispatched[n]);
+    }
+    synth_train_free(train);
+}
+
+int main(void) {
+    for (uint32_t trial = 0; trial < TRIALS; trial++) {
+        test_equivalence(trial);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,212 @@
+#include "test_utils.h"
+#include "rf433_diversity.h"
+
+#include <sys/param.h>
+
+/*
+ Diversity combining on synthesized streams of two receivers hearing the same transmitter.
+*/
+
+#define BURSTS    20
+#define REPEATS   8
+#define WINDOW_US 200000
+#define FRAME_US  40000
+#define DROPPED   3                 // frame missed by the leader
+
+typedef struct {
+    int starts;
+    int continues;
+    int stops;
+    int wrong;
+} stats_t;
+
+static void count(stats_t *stats, const rf_event_t *event, uint64_t code) {
+    switch (event->action) {
+        case RF_ACTION_START:
+            stats->starts++;
+            break;
+        case RF_ACTION_CONTINUE:
+            stats->continues++;
+            break;
+        case RF_ACTION_STOP:
+            stats->stops++;
+            break;
+    }
+    if (event->raw_code != code) {
+        stats->wrong++;
+    }
+}
+
+/*
+ * @brief Feed pulses of both receivers in order of time, like the ISR queue does
+ *
+ * single: events of every receiver alone, combined: events passed by the combiner
+ */
+static void run(diversity_t *d, parser_t **parsers, pulse_train_t **trains, uint64_t code,
+                stats_t *single, stats_t *combined) {
+    size_t next[2] = {0, 0};
+    int64_t end_us[2] = {0, 0};        // time when the current pulse of the receiver ends
+    rf_event_t event;
+    int n;
+
+    for (;;) {
+        int r;
+        if (next[0] < trains[0]->len && next[1] < trains[1]->len) {
+            r = end_us[0] + trains[0]->pulses[next[0]].time_us <= end_us[1] + trains[1]->pulses[next[1]].time_us ? 0 : 1;
+        } else if (next[0] < trains[0]->len || next[1] < trains[1]->len) {
+            r = next[0] < trains[0]->len ? 0 : 1;
+        } else {
+            break;
+        }
+        pulse_t pulse = trains[r]->pulses[next[r]++];
+        pulse.receiver = r;
+        end_us[r] += pulse.time_us;
+
+        if (parsers[r]->input(parsers[r], &pulse, &event)) {
+            count(&single[r], &event, code);
+            if (diversity_input(d, r, 0, &event, end_us[r])) {
+                count(combined, &event, code);
+            }
+        }
+        while (diversity_flush(d, end_us[r], &event, &n)) {
+            TEST_ASSERT_EQUAL(0, n);
+            count(combined, &event, code);
+        }
+    }
+    // the task wakes up when the window is over
+    while (diversity_flush(d, MAX(end_us[0], end_us[1]) + WINDOW_US, &event, &n)) {
+        count(combined, &event, code);
+    }
+}
+
+/*
+ * Every receiver loses frames on its own, sequences of both receivers come out as one START and one STOP.
+ */
+static void test_weak_receivers(int n) {
+    parser_t *parsers[2] = {test_parser_new(n), test_parser_new(n)};
+    pulse_train_t *clean = synth_train_new(0);
+    pulse_train_t *trains[2] = {synth_train_new(0), synth_train_new(0)};
+    diversity_t d;
+    uint32_t seed = n + 1;
+    stats_t total_single[2] = {0}, total_combined = {0};
+
+    diversity_init(&d, WINDOW_US);
+    for (int burst = 0; burst < BURSTS; burst++) {
+        uint64_t code = test_random_code(n, &seed);
+        synth_train_clear(clean);
+        TEST_ASSERT_EQUAL(ESP_OK, test_code(clean, n, code, REPEATS));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(clean, 0, 20000));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_reset(clean));
+        for (int r = 0; r < 2; r++) {
+            // the second receiver hears the edges a bit later
+            synth_impairments_t impairments = {.jitter_us = 5, .noise_permille = 15, .noise_us = 40,
+                                               .seed = burst * 2 + r + 1};
+            synth_train_clear(trains[r]);
+            TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(trains[r], 0, 10000 + r * 30));
+            TEST_ASSERT_EQUAL(ESP_OK, synth_impair(trains[r], clean, &impairments));
+        }
+
+        stats_t single[2] = {0}, combined = {0};
+        run(&d, parsers, trains, code, single, &combined);
+        TEST_ASSERT_EQUAL(0, combined.wrong);
+        if (single[0].starts + single[1].starts > 0) {
+            TEST_ASSERT_EQUAL(1, combined.starts);
+            TEST_ASSERT_EQUAL(1, combined.stops);
+        }
+        for (int r = 0; r < 2; r++) {
+            total_single[r].starts += single[r].starts;
+            total_single[r].continues += single[r].continues;
+        }
+        total_combined.starts += combined.starts;
+        total_combined.continues += combined.continues;
+    }
+    printf("%-10s frames: receiver 0 %d, receiver 1 %d, combined %d\n", synth_protocols[n].name,
+           total_single[0].starts + total_single[0].continues, total_single[1].starts + total_single[1].continues,
+           total_combined.starts + total_combined.continues);
+    TEST_ASSERT(!diversity_pending(&d));
+    TEST_ASSERT(total_combined.starts > BURSTS / 2);
+    for (int r = 0; r < 2; r++) {
+        TEST_ASSERT(total_combined.starts + total_combined.continues >=
+                    total_single[r].starts + total_single[r].continues);
+    }
+
+    synth_train_free(trains[1]);
+    synth_train_free(trains[0]);
+    synth_train_free(clean);
+}
+
+/*
+ * The leader misses one frame in the middle of the transmission without stopping the sequence, the other
+ * receiver fills it in at once and no frame is passed twice.
+ */
+static void test_leader_drops_frame(void) {
+    diversity_t d;
+    rf_event_t event;
+    int n, passed = 0;
+
+    diversity_init(&d, WINDOW_US);
+    for (int frame = 0; frame < REPEATS; frame++) {
+        int64_t frame_us = frame * FRAME_US;
+        for (int r = 0; r < 2; r++) {
+            if (r == 0 && frame == DROPPED) {
+                continue;
+            }
+            // the second receiver decodes every frame a bit later
+            event = (rf_event_t) {.action = frame ? RF_ACTION_CONTINUE : RF_ACTION_START, .raw_code = 0x1234,
+                                  .protocol = 1, .bits = 24};
+            if (diversity_input(&d, r, 0, &event, frame_us + r * 300)) {
+                TEST_ASSERT_EQUAL(frame ? RF_ACTION_CONTINUE : RF_ACTION_START, event.action);
+                TEST_ASSERT_EQUAL(frame == DROPPED, r == 1);
+                passed++;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(REPEATS, passed);
+
+    for (int r = 0; r < 2; r++) {
+        event = (rf_event_t) {.action = RF_ACTION_STOP, .raw_code = 0x1234, .protocol = 1, .bits = 24};
+        TEST_ASSERT(!diversity_input(&d, r, 0, &event, REPEATS * FRAME_US));
+    }
+    TEST_ASSERT(diversity_flush(&d, REPEATS * FRAME_US + WINDOW_US, &event, &n));
+    TEST_ASSERT_EQUAL(RF_ACTION_STOP, event.action);
+    TEST_ASSERT(!diversity_pending(&d));
+}
+
+/*
+ * When all slots are taken the event is dropped, the sequences in slots go on normally
+ */
+static void test_full_slots(void) {
+    diversity_t d;
+    rf_event_t event;
+    int n;
+
+    diversity_init(&d, WINDOW_US);
+    for (int code = 0; code <= DIVERSITY_SLOTS; code++) {
+        event = (rf_event_t) {.action = RF_ACTION_START, .raw_code = code, .protocol = 1, .bits = 24};
+        TEST_ASSERT_EQUAL(code < DIVERSITY_SLOTS, diversity_input(&d, 0, code, &event, 0));
+    }
+    // continuation of the dropped code doesn't start a sequence while slots are full
+    event = (rf_event_t) {.action = RF_ACTION_CONTINUE, .raw_code = DIVERSITY_SLOTS, .protocol = 1, .bits = 24};
+    TEST_ASSERT(!diversity_input(&d, 0, DIVERSITY_SLOTS, &event, 1000));
+
+    for (int code = 0; code <= DIVERSITY_SLOTS; code++) {
+        event = (rf_event_t) {.action = RF_ACTION_STOP, .raw_code = code, .protocol = 1, .bits = 24};
+        TEST_ASSERT(!diversity_input(&d, 0, code, &event, 2000));
+    }
+    TEST_ASSERT(!diversity_flush(&d, 2000 + WINDOW_US - 1, &event, &n));
+    for (int code = 0; code < DIVERSITY_SLOTS; code++) {
+        TEST_ASSERT(diversity_flush(&d, 2000 + WINDOW_US, &event, &n));
+        TEST_ASSERT_EQUAL(RF_ACTION_STOP, event.action);
+        TEST_ASSERT_EQUAL(n, event.raw_code);
+    }
+    TEST_ASSERT(!diversity_flush(&d, 2000 + WINDOW_US, &event, &n));
+}
+
+int main(void) {
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        test_weak_receivers(n);
+    }
+    test_leader_drops_frame();
+    test_full_slots();
+    return EXIT_SUCCESS;
+}
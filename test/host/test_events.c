@@ -0,0 +1,72 @@
+#include "test_utils.h"
+#include "rf433_events.h"
+
+/*
+ Broadcast ring of events: order, lost events and wrap around of the sequence numbers.
+*/
+
+static void write_events(events_ring_t *ring, uint64_t first, int num) {
+    for (int n = 0; n < num; n++) {
+        rf_event_t event = {.raw_code = first + n};
+        events_ring_write(ring, &event);
+    }
+}
+
+static void read_events(rf_events_reader_handle_t reader, uint64_t first, int num, uint32_t first_missed) {
+    rf_event_t event;
+    uint32_t missed;
+    for (int n = 0; n < num; n++) {
+        TEST_ASSERT_EQUAL(ESP_OK, events_ring_read(reader, &event, &missed, 0));
+        TEST_ASSERT_EQUAL(first + n, event.raw_code);
+        TEST_ASSERT_EQUAL(n == 0 ? first_missed : 0, missed);
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, events_ring_read(reader, &event, &missed, 0));
+}
+
+static void test_size(void) {
+    events_ring_t *ring = events_ring_new(5);
+    TEST_ASSERT(ring != NULL);
+    TEST_ASSERT_EQUAL(8, ring->size);
+    TEST_ASSERT(events_ring_new(0) == NULL);
+}
+
+static void test_lost_events(void) {
+    events_ring_t *ring = events_ring_new(8);
+    rf_events_reader_handle_t reader = events_ring_reader_new(ring);
+
+    write_events(ring, 0, 5);
+    TEST_ASSERT_EQUAL(5, events_ring_lag(reader));
+    read_events(reader, 0, 5, 0);
+
+    write_events(ring, 5, 11);
+    TEST_ASSERT_EQUAL(11, events_ring_lag(reader));
+    read_events(reader, 8, 8, 3);
+    events_ring_reader_delete(reader);
+}
+
+/*
+ * Events around the wrap of 32-bit sequence numbers come in order, any ring size
+ */
+static void test_wrap(size_t size) {
+    events_ring_t *ring = events_ring_new(size);
+    rf_events_reader_handle_t reader = events_ring_reader_new(ring);
+    ring->head = UINT32_MAX - 2;
+    reader->cursor = ring->head;
+
+    write_events(ring, 100, 4);
+    TEST_ASSERT_EQUAL(1, ring->head);
+    read_events(reader, 100, 4, 0);
+
+    write_events(ring, 200, (int) ring->size + 2);
+    read_events(reader, 202, (int) ring->size, 2);
+    events_ring_reader_delete(reader);
+}
+
+int main(void) {
+    test_size();
+    test_lost_events();
+    for (size_t size = 3; size <= 17; size++) {
+        test_wrap(size);
+    }
+    return EXIT_SUCCESS;
+}
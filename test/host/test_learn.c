@@ -0,0 +1,97 @@
+#include "test_utils.h"
+#include "rf433_learn.h"
+
+/*
+ Round trip of the learning mode: a transmission with jitter is learned, and the parser created from
+ the learned parameters must decode other transmissions of the protocol.
+*/
+
+#define LEARN_REPEATS  8            // the button is held for a while
+#define REPEATS        4
+#define BURSTS         10
+#define JITTER_MAX_US  20
+
+static int jitter_us(int n) {  // up to 10% of the clock tick of pulse width protocols
+    int clock_us = synth_protocols[n].clock_us;
+    return clock_us == 0 || clock_us / 10 > JITTER_MAX_US ? JITTER_MAX_US : clock_us / 10;
+}
+
+static void transmission(pulse_train_t *train, int n, uint64_t code, int repeats, uint32_t seed) {
+    pulse_train_t *clean = synth_train_new(0);
+    synth_impairments_t impairments = {.jitter_us = jitter_us(n), .seed = seed};
+
+    TEST_ASSERT_EQUAL(ESP_OK, test_code(clean, n, code, repeats));
+    TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(clean, 0, 20000));
+    TEST_ASSERT_EQUAL(ESP_OK, synth_reset(clean));
+    synth_train_clear(train);
+    TEST_ASSERT_EQUAL(ESP_OK, synth_impair(train, clean, &impairments));
+    synth_train_free(clean);
+}
+
+static void test_round_trip(int n) {
+    bool pulse_width = synth_protocols[n].config.code_bits_len != 0;
+    pulse_train_t *train = synth_train_new(0);
+    uint32_t seed = n + 1;
+    rf_learned_protocol_t learned;
+
+    uint64_t code = test_random_code(n, &seed);
+    transmission(train, n, code, LEARN_REPEATS, seed);
+    TEST_ASSERT_EQUAL(ESP_OK, learn_analyze(train->pulses, train->len, &learned));
+    printf("%-10s jitter %2d us: encoding %d, bits %d, code 0x%llx, sync_clk %d, bit_clk %d, frames %d\n",
+           synth_protocols[n].name, jitter_us(n), learned.encoding, learned.code_bits_len,
+           (unsigned long long) learned.raw_code, learned.sync_clk, learned.bit_clk, learned.frames);
+    TEST_ASSERT_EQUAL(pulse_width ? RF_ENCODING_PULSE_WIDTH : RF_ENCODING_PULSE_DISTANCE, learned.encoding);
+    TEST_ASSERT_EQUAL(code, learned.raw_code);
+
+    // the descriptor lives as long as the parser
+    pulse_parser_config_t config;
+    pd_protocol_t descriptor;
+    parser_t *parser;
+    if (pulse_width) {
+        learn_pulse_config(&learned, &config);
+        TEST_ASSERT_EQUAL(synth_protocols[n].config.inverted, config.inverted);
+        parser = pulse_parser_new(&config);
+    } else {
+        learn_pd_protocol(&learned, &descriptor);
+        parser = pd_parser_new(&descriptor, 1);
+    }
+    TEST_ASSERT(parser != NULL);
+
+    int starts = 0;
+    for (int burst = 0; burst < BURSTS; burst++) {
+        code = test_random_code(n, &seed);
+        transmission(train, n, code, REPEATS, seed);
+        rf_event_t event;
+        for (size_t i = 0; i < train->len; i++) {
+            if (parser->input(parser, &train->pulses[i], &event) && event.action != RF_ACTION_STOP) {
+                TEST_ASSERT_EQUAL(code, event.raw_code);
+                starts += event.action == RF_ACTION_START;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(BURSTS, starts);
+
+    parser->del(parser);
+    synth_train_free(train);
+}
+
+static void test_noise_only(void) {
+    pulse_train_t *train = synth_train_new(0);
+    uint32_t seed = 1;
+    rf_learned_protocol_t learned;
+
+    for (int n = 0; n < 1000; n++) {
+        seed = seed * 1103515245 + 12345;
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, n % 2, 50 + (seed >> 16) % 2000));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, learn_analyze(train->pulses, train->len, &learned));
+    synth_train_free(train);
+}
+
+int main(void) {
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        test_round_trip(n);
+    }
+    test_noise_only();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#include "test_utils.h"
+
+/*
+ Several descriptors of the pulse distance parser emitting events on the same pulse.
+*/
+
+static void test_events_of_one_pulse(void) {
+    pd_protocol_t protocols[2] = {RF_PROTOCOL_KINGSERRY, RF_PROTOCOL_KINGSERRY};
+    protocols[1].id = 0x0001;
+    parser_t *parser = pd_parser_new(protocols, 2);
+    TEST_ASSERT(parser != NULL);
+
+    pulse_train_t *train = synth_train_new(0);
+    uint64_t code = 0x2F7702018CULL;
+    TEST_ASSERT_EQUAL(ESP_OK, synth_nec_code(train, code, 4));
+    TEST_ASSERT_EQUAL(ESP_OK, synth_reset(train));
+
+    int actions[3] = {0};
+    rf_event_t first, second, none;
+    for (size_t i = 0; i < train->len; i++) {
+        if (!parser->input(parser, &train->pulses[i], &first)) {
+            continue;
+        }
+        // both descriptors decode the frame, the second event is there right away
+        TEST_ASSERT(parser->next_event(parser, &second));
+        TEST_ASSERT(!parser->next_event(parser, &none));
+        TEST_ASSERT_EQUAL(0x0000, first.protocol);
+        TEST_ASSERT_EQUAL(0x0001, second.protocol);
+        TEST_ASSERT_EQUAL(first.action, second.action);
+        TEST_ASSERT_EQUAL(code, first.raw_code);
+        TEST_ASSERT_EQUAL(code, second.raw_code);
+        actions[first.action]++;
+    }
+    TEST_ASSERT_EQUAL(1, actions[RF_ACTION_START]);
+    TEST_ASSERT_EQUAL(2, actions[RF_ACTION_CONTINUE]);
+    TEST_ASSERT_EQUAL(1, actions[RF_ACTION_STOP]);
+    TEST_ASSERT(parser->is_idle(parser));
+    synth_train_free(train);
+}
+
+int main(void) {
+    test_events_of_one_pulse();
+    return EXIT_SUCCESS;
+}
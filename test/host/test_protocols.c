@@ -0,0 +1,229 @@
+#include "test_utils.h"
+
+#include <esp_timer.h>
+
+/*
+ Conformance of all protocols on synthesized transmissions of real transmitters (see synth_protocols)
+ and throughput of their parsers.
+*/
+
+#define BURSTS         20
+#define REPEATS        6
+#define GLITCH_REPEAT  2            // repeat damaged by a glitch
+#define GLITCH_US      20
+#define MIN_PULSES_PER_SEC 200000   // way above what a receiver can deliver
+
+typedef struct {
+    int starts;
+    int continues;
+    int stops;
+    int wrong;                       // START or CONTINUE with a code that was not sent
+} stats_t;
+
+static void feed(parser_t *parser, const pulse_train_t *train, uint64_t code, stats_t *stats) {
+    rf_event_t event;
+    for (size_t i = 0; i < train->len; i++) {
+        if (!parser->input(parser, &train->pulses[i], &event)) {
+            continue;
+        }
+        switch (event.action) {
+            case RF_ACTION_START:
+                stats->starts++;
+                break;
+            case RF_ACTION_CONTINUE:
+                stats->continues++;
+                break;
+            case RF_ACTION_STOP:
+                stats->stops++;
+                continue;
+        }
+        if (event.raw_code != code) {
+            stats->wrong++;
+        }
+    }
+}
+
+/*
+ * Every burst is a separate transmission of a new code: it must be reported with exactly one START
+ * and one STOP, and a code that was not sent must never be reported.
+ */
+static void test_conformance(int n, const synth_impairments_t *impairments) {
+    parser_t *parser = test_parser_new(n);
+    pulse_train_t *clean = synth_train_new(0);
+    pulse_train_t *train = synth_train_new(0);
+    uint32_t seed = n + 1;
+    stats_t stats = {0};
+
+    for (int burst = 0; burst < BURSTS; burst++) {
+        uint64_t code = test_random_code(n, &seed);
+        synth_train_clear(clean);
+        synth_train_clear(train);
+        TEST_ASSERT_EQUAL(ESP_OK, test_code(clean, n, code, REPEATS));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(clean, 0, 20000));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_reset(clean));
+
+        synth_impairments_t burst_impairments = *impairments;
+        burst_impairments.seed += burst;
+        TEST_ASSERT_EQUAL(ESP_OK, synth_impair(train, clean, &burst_impairments));
+        feed(parser, train, code, &stats);
+    }
+    printf("%-10s skew %+5d ppm, jitter %2d us, duty %+3d us: START %d, CONTINUE %d, STOP %d, wrong %d\n",
+           synth_protocols[n].name, impairments->skew_ppm, impairments->jitter_us, impairments->duty_us,
+           stats.starts, stats.continues, stats.stops, stats.wrong);
+
+    TEST_ASSERT_EQUAL(0, stats.wrong);
+    TEST_ASSERT_EQUAL(BURSTS, stats.starts);
+    TEST_ASSERT_EQUAL(BURSTS, stats.stops);
+    TEST_ASSERT(stats.continues > 0);
+
+    synth_train_free(train);
+    synth_train_free(clean);
+}
+
+/*
+ * @brief Feed a single transmission, its events must be START, CONTINUE... and STOP with the sent code
+ *
+ * @return
+ *      number of codes reported with the pulses from the given one
+ */
+static int feed_transmission(parser_t *parser, const pulse_train_t *train, uint64_t code, size_t from) {
+    rf_event_t event;
+    int codes = 0;
+    bool started = false, stopped = false;
+    for (size_t i = 0; i < train->len; i++) {
+        if (!parser->input(parser, &train->pulses[i], &event)) {
+            continue;
+        }
+        TEST_ASSERT(!stopped);
+        switch (event.action) {
+            case RF_ACTION_START:
+                TEST_ASSERT(!started);
+                started = true;
+                break;
+            case RF_ACTION_CONTINUE:
+                TEST_ASSERT(started);
+                break;
+            case RF_ACTION_STOP:
+                TEST_ASSERT(started);
+                stopped = true;
+                break;
+        }
+        TEST_ASSERT_EQUAL(code, event.raw_code);
+        codes += event.action != RF_ACTION_STOP && i >= from;
+    }
+    TEST_ASSERT(stopped);
+    return codes;
+}
+
+/*
+ * A glitch in one repeat costs that repeat at most: the transmission goes on without a new START and
+ * all later repeats are decoded. The glitch is tried on every pulse of the repeat.
+ */
+static void test_glitch_in_repeat(int n) {
+    parser_t *parser = test_parser_new(n);
+    pulse_train_t *clean = synth_train_new(0);
+    pulse_train_t *train = synth_train_new(0);
+    uint32_t seed = n + 1;
+    uint64_t code = test_random_code(n, &seed);
+    int bits = synth_protocols[n].config.code_bits_len ? synth_protocols[n].config.code_bits_len : 40;
+    size_t frame_len = 2 * (bits + 1);  // the code bits and SYNC (START of King-Serry) pairs
+
+    TEST_ASSERT_EQUAL(ESP_OK, test_code(clean, n, code, REPEATS));
+    TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(clean, 0, 20000));
+    TEST_ASSERT_EQUAL(ESP_OK, synth_reset(clean));
+
+    // a code is reported with SYNC after it (King-Serry: START of the next frame)
+    size_t later = (GLITCH_REPEAT + 2) * frame_len - 1;
+    int expected = feed_transmission(parser, clean, code, later);
+    TEST_ASSERT(expected > 0);
+
+    for (size_t k = 0; k < frame_len; k++) {
+        size_t glitch = GLITCH_REPEAT * frame_len + k;
+        synth_train_clear(train);
+        for (size_t i = 0; i < clean->len; i++) {
+            const pulse_t *pulse = &clean->pulses[i];
+            if (i == glitch) {
+                int head_us = (pulse->time_us - GLITCH_US) / 2;
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, pulse->level, head_us));
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, !pulse->level, GLITCH_US));
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, pulse->level, pulse->time_us - GLITCH_US - head_us));
+            } else if (pulse->time_us == 0) {
+                TEST_ASSERT_EQUAL(ESP_OK, synth_reset(train));
+            } else {
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, pulse->level, pulse->time_us));
+            }
+        }
+        // the glitch adds 2 pulses
+        int codes = feed_transmission(parser, train, code, later + 2);
+        if (codes != expected) {
+            printf("%-10s glitch at pulse %zu of repeat %d: %d later codes, expected %d\n",
+                   synth_protocols[n].name, k, GLITCH_REPEAT, codes, expected);
+        }
+        TEST_ASSERT_EQUAL(expected, codes);
+    }
+
+    synth_train_free(train);
+    synth_train_free(clean);
+    parser->del(parser);
+}
+
+/*
+ * Clean frames mixed with noise, so both the decoding and the SYNC search are measured.
+ */
+static void test_throughput(int n) {
+    parser_t *parser = test_parser_new(n);
+    pulse_train_t *clean = synth_train_new(0);
+    pulse_train_t *train = synth_train_new(0);
+    uint32_t seed = n + 1;
+
+    for (int burst = 0; burst < 10; burst++) {
+        TEST_ASSERT_EQUAL(ESP_OK, test_code(clean, n, test_random_code(n, &seed), REPEATS));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(clean, 0, 20000));
+    }
+    synth_impairments_t impairments = {.noise_permille = 100, .noise_us = 50, .jitter_us = 10, .seed = 1};
+    TEST_ASSERT_EQUAL(ESP_OK, synth_impair(train, clean, &impairments));
+
+    rf_event_t event;
+    uint32_t pulses = 0;
+    int64_t started_us = esp_timer_get_time();
+    int64_t elapsed_us;
+    do {
+        for (size_t i = 0; i < train->len; i++) {
+            parser->input(parser, &train->pulses[i], &event);
+        }
+        pulses += train->len;
+        elapsed_us = esp_timer_get_time() - started_us;
+    } while (elapsed_us < 50000);
+
+    uint32_t pulses_per_sec = (uint32_t) (pulses * 1000000LL / elapsed_us);
+    printf("%-10s %u pulses per second\n", synth_protocols[n].name, pulses_per_sec);
+    TEST_ASSERT(pulses_per_sec >= MIN_PULSES_PER_SEC);
+
+    synth_train_free(train);
+    synth_train_free(clean);
+}
+
+int main(void) {
+    const synth_impairments_t clean = {.seed = 1};
+    // King-Serry windows allow only +-15 us of SYNC width
+    const synth_impairments_t fast = {.skew_ppm = -5000, .jitter_us = 5, .seed = 1};
+    const synth_impairments_t slow = {.skew_ppm = 5000, .jitter_us = 5, .seed = 1};
+
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        test_conformance(n, &clean);
+        test_conformance(n, &fast);
+        test_conformance(n, &slow);
+
+        // the receiver stretches HIGH or LOW pulses, SYNC ratio window of Protocol 2 allows 4% of the tick
+        int duty_us = synth_protocols[n].clock_us ? synth_protocols[n].clock_us / 25 : 10;
+        test_conformance(n, &(synth_impairments_t) {.duty_us = duty_us, .jitter_us = 5, .seed = 1});
+        test_conformance(n, &(synth_impairments_t) {.duty_us = -duty_us, .jitter_us = 5, .seed = 1});
+    }
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        test_glitch_in_repeat(n);
+    }
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        test_throughput(n);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,271 @@
+#include "test_utils.h"
+
+/*
+ Reactions of the pulse parser to the reset signal of the ISR, to damaged frames and to noise.
+*/
+
+#define BURSTS          50
+#define REPEATS         6
+#define MIN_DECODED     90      // percents of noisy bursts that must be decoded
+#define START_FRAME     3       // frame by the end of which START of a noisy burst is expected
+#define MIN_IN_TIME     70      // percents of decoded noisy bursts with START in time
+#define NOISE_PULSES    200000  // pulses of random noise without any transmission
+
+static const pulse_t s_reset = {.level = 0, .time_us = 0};
+
+typedef struct {
+    int starts;
+    int continues;
+    int stops;
+    int wrong;                  // START or CONTINUE with a code that was not sent
+    int voted;                  // events with the code reconstructed by votes
+    int64_t start_us;           // time from the beginning of the train to the first START
+    int min_confidence;
+} stats_t;
+
+static void feed_stats(parser_t *parser, const pulse_train_t *train, uint64_t code, stats_t *stats) {
+    rf_event_t event;
+    int64_t now_us = 0;
+    for (size_t i = 0; i < train->len; i++) {
+        now_us += train->pulses[i].time_us;
+        if (!parser->input(parser, &train->pulses[i], &event)) {
+            continue;
+        }
+        TEST_ASSERT(event.confidence > 0 && event.confidence <= 100);
+        switch (event.action) {
+            case RF_ACTION_START:
+                if (stats->starts++ == 0) {
+                    stats->start_us = now_us;
+                }
+                break;
+            case RF_ACTION_CONTINUE:
+                stats->continues++;
+                break;
+            case RF_ACTION_STOP:
+                stats->stops++;
+                continue;
+        }
+        if (event.raw_code != code) {
+            stats->wrong++;
+        }
+        if (event.confidence < 100) {
+            stats->voted++;
+        }
+        if (stats->min_confidence == 0 || event.confidence < stats->min_confidence) {
+            stats->min_confidence = event.confidence;
+        }
+    }
+}
+
+static int feed(parser_t *parser, const pulse_t *pulses, size_t len) {
+    rf_event_t event;
+    int events = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (parser->input(parser, &pulses[i], &event)) {
+            events++;
+        }
+    }
+    return events;
+}
+
+/*
+ * A transmission cut by a full queue or a missed interrupt is over: STOP comes with the reset signal
+ * even when it arrives in the middle of a frame.
+ */
+static void test_reset_in_frame(int n) {
+    parser_t *parser = test_parser_new(n);
+    pulse_train_t *train = synth_train_new(0);
+    pulse_train_t *frame = synth_train_new(0);
+    uint32_t seed = n + 1;
+    uint64_t code = test_random_code(n, &seed);
+    rf_event_t event;
+
+    TEST_ASSERT_EQUAL(ESP_OK, test_code(train, n, code, 2));
+    TEST_ASSERT_EQUAL(ESP_OK, test_code(frame, n, code, 1));
+    TEST_ASSERT(feed(parser, train->pulses, train->len) > 0);
+    TEST_ASSERT(!parser->is_idle(parser));
+
+    // half of the next frame, then the reset signal
+    TEST_ASSERT_EQUAL(0, feed(parser, frame->pulses, frame->len / 2));
+    TEST_ASSERT(parser->input(parser, &s_reset, &event));
+    TEST_ASSERT_EQUAL(RF_ACTION_STOP, event.action);
+    TEST_ASSERT_EQUAL(code, event.raw_code);
+    TEST_ASSERT(parser->is_idle(parser));
+
+    // nothing is in progress anymore
+    TEST_ASSERT(!parser->input(parser, &s_reset, &event));
+
+    synth_train_free(frame);
+    synth_train_free(train);
+    parser->del(parser);
+}
+
+/*
+ * Bits of real transmitters are not ideal {1, bit_clk - 1} pairs, Protocol 3 sends {4, 11} and {9, 6}.
+ * They are decided by the longer pulse, so every frame is decoded on its own.
+ */
+static void test_protocol3_bits(void) {
+    const pulse_parser_config_t config = RF_PROTOCOL_3;
+    parser_t *parser = pulse_parser_new(&config);
+    pulse_train_t *train = synth_train_new(0);
+    uint64_t code = 0xA5C30F;
+    stats_t stats = {0};
+
+    TEST_ASSERT(parser != NULL);
+    for (int r = 0; r < REPEATS; r++) {
+        for (int n = config.code_bits_len - 1; n >= 0; n--) {
+            bool bit = (code >> n) & 0x1;
+            TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, 1, bit ? 900 : 400));
+            TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, 0, bit ? 600 : 1100));
+        }
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, 1, 100));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, 0, 10000));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, synth_reset(train));
+    feed_stats(parser, train, code, &stats);
+
+    // every frame with SYNC after it is a code: START + CONTINUE, then STOP on the reset signal
+    TEST_ASSERT_EQUAL(1, stats.starts);
+    TEST_ASSERT_EQUAL(REPEATS - 2, stats.continues);
+    TEST_ASSERT_EQUAL(1, stats.stops);
+    TEST_ASSERT_EQUAL(0, stats.wrong);
+    TEST_ASSERT_EQUAL(0, stats.voted);
+
+    synth_train_free(train);
+    parser->del(parser);
+}
+
+/*
+ * Every frame has a glitch in a different bit, so no frame can be decoded alone and the code
+ * is reconstructed by majority vote with confidence below 100.
+ */
+static void test_vote(int n) {
+    parser_t *parser = test_parser_new(n);
+    pulse_train_t *frame = synth_train_new(0);
+    pulse_train_t *train = synth_train_new(0);
+    uint32_t seed = n + 1;
+    uint64_t code = test_random_code(n, &seed);
+    stats_t stats = {0};
+
+    TEST_ASSERT_EQUAL(ESP_OK, test_code(frame, n, code, 1));
+    for (int r = 0; r < REPEATS; r++) {
+        // 2 pulses per bit, the glitch splits the first pulse of a bit
+        size_t glitch = 2 * (size_t) (3 + r * 4);
+        for (size_t i = 0; i < frame->len; i++) {
+            const pulse_t *pulse = &frame->pulses[i];
+            if (i == glitch) {
+                int head_us = pulse->time_us / 2;
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, pulse->level, head_us));
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, !pulse->level, 20));
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, pulse->level, pulse->time_us - head_us - 20));
+            } else {
+                TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, pulse->level, pulse->time_us));
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, synth_reset(train));
+    feed_stats(parser, train, code, &stats);
+    printf("%-10s voted: START %d, CONTINUE %d, STOP %d, min confidence %d\n", synth_protocols[n].name,
+           stats.starts, stats.continues, stats.stops, stats.min_confidence);
+
+    TEST_ASSERT_EQUAL(1, stats.starts);
+    TEST_ASSERT_EQUAL(1, stats.stops);
+    TEST_ASSERT_EQUAL(0, stats.wrong);
+    TEST_ASSERT_EQUAL(stats.starts + stats.continues, stats.voted);
+    TEST_ASSERT(stats.min_confidence >= 30 && stats.min_confidence < 100);
+
+    synth_train_free(train);
+    synth_train_free(frame);
+    parser->del(parser);
+}
+
+/*
+ * Glitches and jitter on air: most transmissions are decoded within the first frames and a code
+ * that was not sent is never reported.
+ */
+static void test_noisy_frames(int n) {
+    parser_t *parser = test_parser_new(n);
+    pulse_train_t *clean = synth_train_new(0);
+    pulse_train_t *train = synth_train_new(0);
+    pulse_train_t *frame = synth_train_new(0);
+    uint32_t seed = n + 1;
+    int decoded = 0, late = 0, voted = 0;
+    int64_t frame_us;
+
+    for (int burst = 0; burst < BURSTS; burst++) {
+        uint64_t code = test_random_code(n, &seed);
+        synth_train_clear(clean);
+        synth_train_clear(train);
+        synth_train_clear(frame);
+        TEST_ASSERT_EQUAL(ESP_OK, test_code(clean, n, code, REPEATS));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(clean, 0, 20000));
+        TEST_ASSERT_EQUAL(ESP_OK, synth_reset(clean));
+        TEST_ASSERT_EQUAL(ESP_OK, test_code(frame, n, code, 1));
+        frame_us = 0;
+        for (size_t i = 0; i < frame->len; i++) {
+            frame_us += frame->pulses[i].time_us;
+        }
+
+        synth_impairments_t impairments = {
+                .jitter_us = 10, .noise_permille = 10, .noise_us = 20, .seed = 1000 * (n + 1) + burst,
+        };
+        TEST_ASSERT_EQUAL(ESP_OK, synth_impair(train, clean, &impairments));
+
+        stats_t stats = {0};
+        feed_stats(parser, train, code, &stats);
+        TEST_ASSERT_EQUAL(0, stats.wrong);
+        TEST_ASSERT_EQUAL(stats.starts, stats.stops);
+        if (stats.starts != 0) {
+            decoded++;
+            late += stats.start_us > START_FRAME * frame_us + frame_us / 2;
+        }
+        voted += stats.voted;
+    }
+    printf("%-10s noisy: decoded %d of %d, late %d, voted events %d\n", synth_protocols[n].name,
+           decoded, BURSTS, late, voted);
+
+    TEST_ASSERT(decoded * 100 >= BURSTS * MIN_DECODED);
+    TEST_ASSERT((decoded - late) * 100 >= decoded * MIN_IN_TIME);
+
+    synth_train_free(frame);
+    synth_train_free(train);
+    synth_train_free(clean);
+    parser->del(parser);
+}
+
+/*
+ * Random pulses of a receiver with AGC in silence must not produce codes.
+ */
+static void test_false_positives(int n) {
+    parser_t *parser = test_parser_new(n);
+    pulse_train_t *train = synth_train_new(NOISE_PULSES);
+    uint32_t seed = 0x1F2E3D4C + n;
+    stats_t stats = {0};
+
+    for (int i = 0; i < NOISE_PULSES; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int width = (seed & 0x7) == 0 ? 50 + (int) (seed >> 8) % 15000 : 20 + (int) (seed >> 8) % 1000;
+        TEST_ASSERT_EQUAL(ESP_OK, synth_pulse(train, i & 1, width));
+    }
+    feed_stats(parser, train, 0, &stats);
+    printf("%-10s noise: %d codes in %d pulses\n", synth_protocols[n].name, stats.starts, NOISE_PULSES);
+    TEST_ASSERT_EQUAL(0, stats.starts);
+
+    synth_train_free(train);
+    parser->del(parser);
+}
+
+int main(void) {
+    test_protocol3_bits();
+    for (int n = 0; n < SYNTH_PROTOCOLS_NUM; n++) {
+        if (synth_protocols[n].config.code_bits_len != 0) {
+            test_reset_in_frame(n);
+            test_vote(n);
+            test_noisy_frames(n);
+            test_false_positives(n);
+        }
+    }
+    return EXIT_SUCCESS;
+}
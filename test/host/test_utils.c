@@ -0,0 +1,28 @@
+#include "test_utils.h"
+
+static const pd_protocol_t s_kingserry = RF_PROTOCOL_KINGSERRY;
+
+parser_t *test_parser_new(int n) {
+    const synth_protocol_t *protocol = &synth_protocols[n];
+    parser_t *parser = protocol->config.code_bits_len ? pulse_parser_new(&protocol->config)
+                                                      : pd_parser_new(&s_kingserry, 1);
+    TEST_ASSERT(parser != NULL);
+    return parser;
+}
+
+esp_err_t test_code(pulse_train_t *train, int n, uint64_t code, int repeats) {
+    if (synth_protocols[n].config.code_bits_len == 0) {
+        return synth_nec_code(train, code, repeats);
+    }
+    return synth_pulse_code(train, &synth_protocols[n], code, repeats);
+}
+
+uint64_t test_random_code(int n, uint32_t *seed) {
+    int bits = synth_protocols[n].config.code_bits_len ? synth_protocols[n].config.code_bits_len : 40;
+    uint64_t code = 0;
+    for (int i = 0; i < 4; i++) {
+        *seed = *seed * 1103515245 + 12345;
+        code = (code << 16) | (*seed >> 16);
+    }
+    return code & ((1ULL << bits) - 1);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ Minimal assertions for the host tests: the first failed check prints the location and fails the test.
+*/
+
+#define TEST_ASSERT(cond) do {                                                  \
+        if (!(cond)) {                                                          \
+            printf("%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE);                                                 \
+        }                                                                       \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) do {                                \
+        long long e_ = (long long)(expected), a_ = (long long)(actual);         \
+        if (e_ != a_) {                                                         \
+            printf("%s:%d: %s: expected %lld, got %lld\n",                      \
+                   __FILE__, __LINE__, #actual, e_, a_);                        \
+            exit(EXIT_FAILURE);                                                 \
+        }                                                                       \
+    } while (0)
+
+#include "rf433_synth.h"
+#include "rf433_protocols.h"
+
+/**
+ * @brief Create a parser of the protocol, n is the index in synth_protocols
+ */
+parser_t *test_parser_new(int n);
+
+/**
+ * @brief Append transmission of the code with the protocol
+ */
+esp_err_t test_code(pulse_train_t *train, int n, uint64_t code, int repeats);
+
+/**
+ * @brief Random code of the protocol, same seed gives the same sequence
+ */
+uint64_t test_random_code(int n, uint32_t *seed);